@@ -0,0 +1,387 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+/*
+ * Engine-scale benchmarks. Each benchmark is run for each entity count and storage mode, and the results are written
+ * to stdout (or the file given with --output) as JSON.
+ *
+ * Usage: AshleyCPPBench [--output <file>] [entity counts...]
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ashley/Ashley.hpp"
+
+using ashley::Engine;
+using ashley::Entity;
+using ashley::Family;
+using ashley::Prefab;
+
+namespace {
+class PositionComponent : public ashley::Component {
+public:
+	explicit PositionComponent(float x = 0.0f, float y = 0.0f) :
+			        x(x),
+			        y(y) {
+	}
+
+	float x;
+	float y;
+};
+
+class VelocityComponent : public ashley::Component {
+public:
+	explicit VelocityComponent(float x = 1.0f, float y = 1.0f) :
+			        x(x),
+			        y(y) {
+	}
+
+	float x;
+	float y;
+};
+
+class HealthComponent : public ashley::Component {
+public:
+	int32_t health = 100;
+};
+
+// distinct types so that several can be added to one engine
+template<int N> class MovementSystem : public ashley::IteratingSystem {
+public:
+	MovementSystem() :
+			        IteratingSystem(Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)}), N) {
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		auto position = entity->getComponent<PositionComponent>();
+		const auto velocity = entity->getComponent<VelocityComponent>();
+
+		position->x += velocity->x * deltaTime;
+		position->y += velocity->y * deltaTime;
+	}
+};
+
+constexpr int updateIterations = 10;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+	std::string name;
+	std::string storage;
+	std::size_t entities;
+	int iterations;
+	int64_t totalNanoseconds;
+};
+
+class Benchmark {
+public:
+	Benchmark(Engine::StorageMode storageMode, std::size_t entityCount, std::vector<Result> &results) :
+			        storageMode(storageMode),
+			        entityCount(entityCount),
+			        results(results) {
+	}
+
+	void runAll() {
+		entityCreation();
+		bulkEntityCreation();
+		componentAddRemove();
+		familyRegistration();
+		update();
+		changeTracking();
+		removal();
+	}
+
+private:
+	Engine::StorageMode storageMode;
+	std::size_t entityCount;
+	std::vector<Result> &results;
+
+	template<typename F> void measure(const std::string &name, int iterations, F &&body) {
+		const auto start = Clock::now();
+		body();
+		const auto end = Clock::now();
+
+		results.push_back(Result { name, storageMode == Engine::StorageMode::ARCHETYPE ? "archetype" : "heap",
+		        entityCount, iterations, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() });
+	}
+
+	std::vector<Entity *> populate(Engine &engine) {
+		std::vector<Entity *> entities;
+		entities.reserve(entityCount);
+
+		for (std::size_t i = 0u; i < entityCount; ++i) {
+			entities.push_back(engine.addEntity());
+			entities.back()->add<PositionComponent>().add<VelocityComponent>();
+		}
+
+		return entities;
+	}
+
+	void entityCreation() {
+		Engine engine(storageMode);
+
+		measure("entity_creation", 1, [&]() {
+			for (std::size_t i = 0u; i < entityCount; ++i) {
+				engine.addEntity();
+			}
+		});
+	}
+
+	void bulkEntityCreation() {
+		Engine oneByOne(storageMode);
+		oneByOne.getEntitiesFor(Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)}));
+
+		measure("entity_creation_with_components", 1, [&]() {
+			populate(oneByOne);
+		});
+
+		Engine bulk(storageMode);
+		bulk.getEntitiesFor(Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)}));
+
+		measure("bulk_entity_creation_with_components", 1, [&]() {
+			bulk.addEntities<PositionComponent, VelocityComponent>(entityCount);
+		});
+
+		Engine prefabs(storageMode);
+		prefabs.getEntitiesFor(Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)}));
+
+		Prefab prefab;
+		prefab.add<PositionComponent>().add<VelocityComponent>();
+
+		measure("prefab_instantiation", 1, [&]() {
+			prefabs.instantiate(prefab, entityCount);
+		});
+	}
+
+	void componentAddRemove() {
+		Engine engine(storageMode);
+		std::vector<Entity *> entities;
+		entities.reserve(entityCount);
+
+		engine.getEntitiesFor(Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)}));
+
+		for (std::size_t i = 0u; i < entityCount; ++i) {
+			entities.push_back(engine.addEntity());
+			entities.back()->add<PositionComponent>();
+		}
+
+		measure("component_add", 1, [&]() {
+			for (auto entity : entities) {
+				entity->add<VelocityComponent>();
+			}
+		});
+
+		measure("component_remove", 1, [&]() {
+			for (auto entity : entities) {
+				entity->remove<VelocityComponent>();
+			}
+		});
+	}
+
+	void familyRegistration() {
+		Engine engine(storageMode);
+		const auto entities = populate(engine);
+
+		for (std::size_t i = 0u; i < entityCount; i += 2) {
+			entities[i]->add<HealthComponent>();
+		}
+
+		measure("family_registration", 1, [&]() {
+			engine.getEntitiesFor(Family::getFor({typeid(PositionComponent), typeid(HealthComponent)}));
+		});
+	}
+
+	void update() {
+		Engine engine(storageMode);
+		populate(engine);
+
+		engine.addSystem<MovementSystem<0>>();
+		engine.addSystem<MovementSystem<1>>();
+		engine.addSystem<MovementSystem<2>>();
+		engine.addSystem<MovementSystem<3>>();
+
+		measure("update_4_iterating_systems", updateIterations, [&]() {
+			for (int i = 0; i < updateIterations; ++i) {
+				engine.update(0.016f);
+			}
+		});
+	}
+
+	void changeTracking() {
+		Engine engine(storageMode);
+		const auto entities = populate(engine);
+
+		engine.trackChanges<VelocityComponent>();
+		engine.update(0.016f);
+
+		// as in a system which only reacts to the few entities whose velocity changed since it last ran
+		const auto tick = engine.getChangeTick();
+
+		for (std::size_t i = 0u; i < entityCount; i += 100) {
+			entities[i]->markChanged<VelocityComponent>();
+		}
+
+		int64_t sum = 0;
+		auto view = engine.view<const PositionComponent, const VelocityComponent>();
+
+		measure("view_all_entities", updateIterations, [&]() {
+			for (int i = 0; i < updateIterations; ++i) {
+				view.each([&](const PositionComponent &position, const VelocityComponent &velocity) {
+					sum += position.x + velocity.x;
+				});
+			}
+		});
+
+		auto changed = view.changedSince<const VelocityComponent>(tick);
+
+		measure("view_changed_entities", updateIterations, [&]() {
+			for (int i = 0; i < updateIterations; ++i) {
+				changed.each([&](const PositionComponent &position, const VelocityComponent &velocity) {
+					sum += position.x + velocity.x;
+				});
+			}
+		});
+
+		// keeps the loops from being optimised away
+		if (sum == 1) {
+			std::cerr << sum;
+		}
+	}
+
+	void removal() {
+		{
+			Engine engine(storageMode);
+			const auto entities = populate(engine);
+
+			measure("entity_removal", 1, [&]() {
+				for (auto entity : entities) {
+					engine.removeEntity(entity);
+				}
+			});
+		}
+
+		{
+			Engine engine(storageMode);
+			populate(engine);
+
+			measure("remove_all_entities", 1, [&]() {
+				engine.removeAllEntities();
+			});
+		}
+	}
+};
+
+void writeJson(std::ostream &out, const std::vector<Result> &results) {
+	out << "{\n  \"benchmarks\": [\n";
+
+	for (std::size_t i = 0u; i < results.size(); ++i) {
+		const auto &result = results[i];
+		const auto perEntity = result.entities == 0u ? 0.0 :
+		        static_cast<double>(result.totalNanoseconds) / result.iterations / result.entities;
+
+		out << "    {\"name\": \"" << result.name << "\", \"storage\": \"" << result.storage << "\", \"entities\": "
+		        << result.entities << ", \"iterations\": " << result.iterations << ", \"total_ns\": "
+		        << result.totalNanoseconds << ", \"ns_per_entity\": " << perEntity << "}"
+		        << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	out << "  ]\n}\n";
+}
+
+/**
+ * Parses a positive entity count, rejecting anything which isn't entirely a base 10 number.
+ */
+bool parseEntityCount(const char *argument, std::size_t &count) {
+	if (*argument < '0' || *argument > '9') {
+		return false;
+	}
+
+	char *end = nullptr;
+	errno = 0;
+	const auto parsed = std::strtoull(argument, &end, 10);
+
+	if (errno != 0 || *end != '\0' || parsed == 0u) {
+		return false;
+	}
+
+	count = static_cast<std::size_t>(parsed);
+	return true;
+}
+
+void printUsage(std::ostream &out) {
+	out << "Usage: AshleyCPPBench [--output <file>] [entity counts...]\n";
+}
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::size_t> entityCounts;
+	std::string outputPath;
+
+	for (int i = 1; i < argc; ++i) {
+		std::size_t count = 0u;
+
+		if (std::strcmp(argv[i], "--help") == 0) {
+			printUsage(std::cout);
+			return 0;
+		} else if (std::strcmp(argv[i], "--output") == 0) {
+			if (i + 1 == argc) {
+				std::cerr << "--output needs a file name\n";
+				printUsage(std::cerr);
+				return 1;
+			}
+
+			outputPath = argv[++i];
+		} else if (parseEntityCount(argv[i], count)) {
+			entityCounts.push_back(count);
+		} else {
+			std::cerr << "Unrecognised argument: " << argv[i] << "\n";
+			printUsage(std::cerr);
+			return 1;
+		}
+	}
+
+	if (entityCounts.empty()) {
+		entityCounts = {1000u, 100000u, 1000000u};
+	}
+
+	std::vector<Result> results;
+
+	for (auto storageMode : {Engine::StorageMode::HEAP, Engine::StorageMode::ARCHETYPE}) {
+		for (auto entityCount : entityCounts) {
+			Benchmark(storageMode, entityCount, results).runAll();
+		}
+	}
+
+	if (outputPath.empty()) {
+		writeJson(std::cout, results);
+	} else {
+		std::ofstream out(outputPath);
+		writeJson(out, results);
+	}
+
+	return 0;
+}
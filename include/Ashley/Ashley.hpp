@@ -20,22 +20,34 @@
 // include all AshleyCPP files here
 #include "AshleyConstants.hpp"
 
+#include "core/Archetype.hpp"
 #include "core/Family.hpp"
 #include "core/Component.hpp"
 #include "core/ComponentMapper.hpp"
 #include "core/ComponentType.hpp"
 #include "core/Engine.hpp"
 #include "core/Entity.hpp"
+#include "core/EntityHandle.hpp"
 #include "core/EntityListener.hpp"
+#include "core/Prefab.hpp"
+#include "core/View.hpp"
 
 #include "signals/Signal.hpp"
 #include "signals/Listener.hpp"
 
 #include "systems/IteratingSystem.hpp"
+#include "systems/ParallelIteratingSystem.hpp"
 #include "systems/IntervalSystem.hpp"
+#include "systems/IntervalIteratingSystem.hpp"
+#include "systems/SortedIteratingSystem.hpp"
+#include "systems/StaticIteratingSystem.hpp"
+#include "systems/StaticIntervalIteratingSystem.hpp"
+#include "systems/StaticSortedIteratingSystem.hpp"
 
 #include "internal/ComponentOperations.hpp"
 
+#include "util/Bits.hpp"
 #include "util/ObjectPools.hpp"
+#include "util/ThreadPool.hpp"
 
 #endif /* ASHLEY_HPP_ */
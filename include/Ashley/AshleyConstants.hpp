@@ -1,15 +1,32 @@
 #ifndef ACPP_ASHLEYCONSTANTS_HPP_
 #define ACPP_ASHLEYCONSTANTS_HPP_
 
-#include <bitset>
+#include "Ashley/util/Bits.hpp"
 
-#ifndef ASHLEY_MAX_COMPONENT_COUNT
-#define ASHLEY_MAX_COMPONENT_COUNT 64
+// Size in bytes of each chunk of component storage used by an Engine in archetype storage mode.
+#ifndef ASHLEY_ARCHETYPE_CHUNK_SIZE
+#define ASHLEY_ARCHETYPE_CHUNK_SIZE 16384
+#endif
+
+// Default number of entities processed per task by a ParallelIteratingSystem.
+#ifndef ASHLEY_PARALLEL_CHUNK_SIZE
+#define ASHLEY_PARALLEL_CHUNK_SIZE 1024
+#endif
+
+// Number of entities allocated at once when an Engine's pool of entities runs out.
+#ifndef ASHLEY_ENTITY_BLOCK_SIZE
+#define ASHLEY_ENTITY_BLOCK_SIZE 256
+#endif
+
+// Size in bytes of each block of memory allocated for components of one type in heap storage mode.
+#ifndef ASHLEY_COMPONENT_BLOCK_SIZE
+#define ASHLEY_COMPONENT_BLOCK_SIZE 16384
 #endif
 
 namespace ashley {
 
-using BitsType = std::bitset<ASHLEY_MAX_COMPONENT_COUNT>;
+// grows with the number of registered component types, so there's no limit on how many can exist
+using BitsType = Bits;
 
 }
 
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_CORE_ARCHETYPE_HPP_
+#define ACPP_CORE_ARCHETYPE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/ComponentType.hpp"
+
+namespace ashley {
+class Entity;
+
+namespace internal {
+class ArchetypeStorage;
+}
+
+/**
+ * <p>Contiguous storage for every {@link Entity} with exactly the same set of {@link Component}s, used by an
+ * {@link Engine} in archetype storage mode.</p>
+ *
+ * <p>Entities are packed into fixed-size chunks and each chunk holds one array per component type, so processing the
+ * components of a chunk streams linearly through memory. Rows are kept dense; when an entity leaves an archetype the
+ * last entity is moved into its place. This means that a component pointer obtained from an entity in archetype
+ * storage is only valid until the next time a component is added to or removed from any entity.</p>
+ *
+ * <p>Archetypes are created and owned by the {@link Engine}; use {@link Engine#getArchetypesFor} to access them.</p>
+ *
+ * @author Ashley Davis (SgtCoDFish)
+ */
+class Archetype {
+public:
+	Archetype(const BitsType &bits, std::size_t chunkBytes);
+	~Archetype();
+
+	Archetype(const Archetype &other) = delete;
+	Archetype(Archetype &&other) = delete;
+	Archetype& operator=(const Archetype &other) = delete;
+	Archetype& operator=(Archetype &&other) = delete;
+
+	/**
+	 * @return the bits of the {@link Component}s that every {@link Entity} in this archetype has.
+	 */
+	inline const BitsType &getComponentBits() const {
+		return bits;
+	}
+
+	/**
+	 * @return the number of {@link Entity}s stored in this archetype.
+	 */
+	inline std::size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @return the maximum number of {@link Entity}s stored in a single chunk; always a power of two.
+	 */
+	inline std::size_t getChunkCapacity() const {
+		return chunkMask + 1;
+	}
+
+	/**
+	 * @return the number of chunks which contain at least one {@link Entity}.
+	 */
+	inline std::size_t getChunkCount() const {
+		return (count + chunkMask) >> chunkShift;
+	}
+
+	/**
+	 * @return the number of {@link Entity}s in the given chunk.
+	 */
+	inline std::size_t getChunkSize(std::size_t chunk) const {
+		const auto start = chunk << chunkShift;
+		return (count - start) < getChunkCapacity() ? (count - start) : getChunkCapacity();
+	}
+
+	/**
+	 * @return an array of {@link getChunkSize} {@link Entity} pointers, in the same order as the chunk's components.
+	 */
+	inline Entity * const *getEntities(std::size_t chunk) const {
+		return reinterpret_cast<Entity * const *>(chunks[chunk].get());
+	}
+
+	/**
+	 * <p>Retrieves the contiguous array of components of type C in a chunk, indexed in the same order as
+	 * {@link Archetype#getEntities}.</p>
+	 * @return an array of {@link getChunkSize} components, or nullptr if this archetype has no such component.
+	 */
+	template<typename C> C *getComponents(std::size_t chunk) const {
+		const auto column = getColumn(ComponentType::getIndexFor<C>());
+		return column == nullptr ? nullptr : reinterpret_cast<C *>(chunks[chunk].get() + column->offset);
+	}
+
+	/**
+	 * <p>Retrieves the component with the given index for a row in this archetype. The component must be part of the
+	 * archetype.</p>
+	 */
+	inline void *getComponent(std::size_t row, uint64_t typeIndex) const {
+		return getSlot(row, columns[columnLookup[typeIndex]]);
+	}
+
+private:
+	struct Column {
+		uint64_t typeIndex;
+		std::size_t offset;
+		ComponentType::Operations operations;
+	};
+
+	BitsType bits;
+
+	std::vector<Column> columns;
+	std::vector<int32_t> columnLookup;
+
+	std::size_t chunkShift;
+	std::size_t chunkMask;
+	std::size_t chunkAllocationSize;
+	std::vector<std::unique_ptr<unsigned char[]>> chunks;
+
+	std::size_t count;
+
+	inline void *getSlot(std::size_t row, const Column &column) const {
+		return chunks[row >> chunkShift].get() + column.offset + (row & chunkMask) * column.operations.size;
+	}
+
+	inline Entity *&getEntitySlot(std::size_t row) {
+		return reinterpret_cast<Entity **>(chunks[row >> chunkShift].get())[row & chunkMask];
+	}
+
+	const Column *getColumn(uint64_t typeIndex) const;
+
+	/**
+	 * Appends a row for the given entity; the components in the row are left uninitialised.
+	 * @return the new row.
+	 */
+	std::size_t push(Entity *entity);
+
+	/**
+	 * Destroys the components in the given row and moves the last row into its place.
+	 * @return the {@link Entity} which was moved into the row, or nullptr if the last row was erased.
+	 */
+	Entity *erase(std::size_t row);
+
+	friend class internal::ArchetypeStorage;
+};
+
+}
+
+#endif /* ACPP_CORE_ARCHETYPE_HPP_ */
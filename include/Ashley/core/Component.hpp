@@ -17,6 +17,9 @@
 #ifndef ACPP_CORE_COMPONENT_HPP_
 #define ACPP_CORE_COMPONENT_HPP_
 
+#include <cassert>
+
+#include <memory>
 #include <typeinfo>
 #include <typeindex>
 
@@ -42,6 +45,26 @@ public:
 	Component& operator=(const Component &other) = default;
 	Component& operator=(Component &&other) = default;
 };
+
+/**
+ * <p>Destroys a {@link Component} as its concrete type and frees it the same way it was allocated, either with delete
+ * or by returning it to its type's pool. Component has no virtual destructor, so components owned by the library are
+ * always held with this deleter.</p>
+ */
+struct ComponentDeleter {
+	void (*release)(Component *component);
+
+	ComponentDeleter(void (*release)(Component *) = nullptr) :
+			        release(release) {
+	}
+
+	inline void operator()(Component *component) const {
+		assert(release != nullptr && "component has no deleter");
+		release(component);
+	}
+};
+
+using ComponentPtr = std::unique_ptr<Component, ComponentDeleter>;
 }
 
 #endif /* COMPONENT_HPP_ */
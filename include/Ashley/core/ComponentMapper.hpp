@@ -17,6 +17,7 @@
 #ifndef ACPP_CORE_COMPONENTMAPPER_HPP_
 #define ACPP_CORE_COMPONENTMAPPER_HPP_
 
+#include <cstdint>
 #include <typeinfo>
 #include <typeindex>
 
@@ -29,6 +30,10 @@ namespace ashley {
 /**
  * <p>Provides super fast {@link Component} retrieval from {@link Entity} objects.</p>
  *
+ * <p>The mapper resolves the index of its {@link ComponentType} once when it's created, so retrieving a component
+ * is a direct index into the entity's storage with no type lookups. Mappers hold no other state and can be shared
+ * between threads.</p>
+ *
  * <em>Java author: David Saltares</em>
  *
  * @param <T> the class type of the {@link Component}.
@@ -48,7 +53,7 @@ public:
 	 * @return {@link ComponentMapper} instance (cached if possible) that provides fast access to the {@link Component} of the specified class.
 	 */
 	static const ComponentMapper<T> getMapper() {
-		return ComponentMapper<T>(typeid(T));
+		return ComponentMapper<T>(ashley::ComponentType::getIndexFor<T>());
 	}
 
 	/**
@@ -56,27 +61,35 @@ public:
 	 * @return {@link ComponentMapper} instance (cached if possible) that provides fast access to the {@link Component} of the specified class.
 	 */
 	static const ComponentMapper<T> getFor(std::type_index index) {
-		return ComponentMapper<T>(index);
+		return ComponentMapper<T>(ashley::ComponentType::getIndexFor(index));
 	}
 
 	/**
 	 * @return The {@link Component} of the specified class belonging to e.
 	 */
-	T *get(Entity *e) const {
-		return e->getComponent<T>();
+	inline T *get(Entity *e) const {
+		return static_cast<T *>(e->getComponentByIndex(componentIndex));
 	}
 
 	/**
 	 * @return Whether or not entity has the component of the specified class.
 	 */
-	bool has(Entity *e) const {
-		return e->hasComponent<T>();
+	inline bool has(Entity *e) const {
+		return e->componentBits[componentIndex];
+	}
+
+	/**
+	 * @return the index of the {@link ComponentType} this mapper retrieves.
+	 */
+	inline uint64_t getComponentIndex() const {
+		return componentIndex;
 	}
 
 private:
-	const ashley::ComponentType componentType;
-	explicit ComponentMapper(std::type_index componentClass) :
-			        componentType(ashley::ComponentType::getFor(componentClass)) {
+	const uint64_t componentIndex;
+
+	explicit ComponentMapper(uint64_t componentIndex) :
+			        componentIndex(componentIndex) {
 	}
 };
 }
@@ -17,11 +17,16 @@
 #ifndef ACPP_CORE_COMPONENTTYPE_HPP_
 #define ACPP_CORE_COMPONENTTYPE_HPP_
 
-#include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
+#include <new>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "Ashley/AshleyConstants.hpp"
 #include "Ashley/core/Component.hpp"
@@ -39,6 +44,35 @@ namespace ashley {
  */
 class ComponentType {
 public:
+	/**
+	 * <p>Type-erased operations on the {@link Component} class represented by a ComponentType. These allow storage
+	 * such as an {@link Archetype} to move and destroy components without knowing their concrete type.</p>
+	 * <p>Only filled in once the type has been seen through one of the templated functions, e.g.
+	 * {@link ComponentType#getFor<C>()} or {@link Entity#add<C>()}; until then <em>size</em> is 0.</p>
+	 */
+	struct Operations {
+		std::size_t size;
+		std::size_t alignment;
+
+		/** Move-constructs a component at destination from source. nullptr if the type isn't move constructible. */
+		void (*moveConstruct)(void *destination, void *source);
+
+		/** Calls the destructor of the component without freeing its memory. */
+		void (*destroy)(void *component);
+
+		/** Destroys and frees a component which was allocated with new. */
+		void (*deleteHeap)(Component *component);
+
+		/** Moves a component into a new heap allocation. nullptr if the type isn't move constructible. */
+		Component *(*moveToHeap)(void *component);
+
+		/**
+		 * Copy-constructs a component at destination from source, with memcpy if the type is trivially copyable.
+		 * nullptr if the type isn't copy constructible.
+		 */
+		void (*copyConstruct)(void *destination, const void *source);
+	};
+
 	ComponentType();
 	~ComponentType() = default;
 	ComponentType(const ComponentType &other) = default;
@@ -51,6 +85,22 @@ public:
 	}
 
 	/**
+	 * @return the type-erased operations for this type; check {@link ComponentType#hasOperations} before use.
+	 */
+	inline const Operations &getOperations() const {
+		return operations;
+	}
+
+	/**
+	 * @return true if this type has been registered through a templated function and so has valid operations.
+	 */
+	inline bool hasOperations() const {
+		return operations.size != 0;
+	}
+
+	/**
+	 * <p>Looks up or registers a type by its std::type_index, which requires a locked hash lookup. Prefer the
+	 * templated versions, which only do this once per type.</p>
 	 * @param componentType The {@link Component} class's type.
 	 * @return A ComponentType matching the Component's class.
 	 */
@@ -60,9 +110,17 @@ public:
 	 * <p>As with std::type_index version but using a templated type instead.</p>
 	 */
 	template<typename C> static ComponentType &getFor() {
-		return ComponentType::getFor(std::type_index(typeid(C)));
+		// looked up once per type; function-local statics are initialised thread-safely
+		static ComponentType &type = registerType<C>();
+		return type;
 	}
 
+	/**
+	 * @param index a component index, as returned by {@link ComponentType#getIndex}.
+	 * @return the ComponentType with the given index, or nullptr if no such type has been registered.
+	 */
+	static const ComponentType *getByIndex(uint64_t index);
+
 	/**
 	 * Quick helper method. The same could be done via {@link ComponentType.getFor()}.
 	 * @param componentType The {@link Component} class's type.
@@ -74,7 +132,8 @@ public:
 	 * <p>As with the std::type_index version but with a templated type instead of an argument</p>
 	 */
 	template<typename C> static uint64_t getIndexFor() {
-		return ComponentType::getIndexFor(std::type_index(typeid(C)));
+		static const uint64_t index = getFor<C>().getIndex();
+		return index;
 	}
 
 	/**
@@ -104,8 +163,70 @@ public:
 private:
 	static uint64_t typeIndex;
 	static std::unordered_map<std::type_index, ComponentType> componentTypes;
+	static std::vector<ComponentType *> typesByIndex;
 
 	uint64_t index;
+	Operations operations;
+
+	template<typename C> static ComponentType &registerType() {
+		auto &type = ComponentType::getFor(std::type_index(typeid(C)));
+
+		if (!type.hasOperations()) {
+			type.operations = makeOperations<C>(std::is_move_constructible<C>());
+		}
+
+		return type;
+	}
+
+	template<typename C> static void moveConstructImpl(void *destination, void *source) {
+		new (destination) C(std::move(*static_cast<C *>(source)));
+	}
+
+	template<typename C> static void destroyImpl(void *component) {
+		static_cast<C *>(component)->~C();
+	}
+
+	template<typename C> static void deleteHeapImpl(Component *component) {
+		delete static_cast<C *>(component);
+	}
+
+	template<typename C> static Component *moveToHeapImpl(void *component) {
+		return new C(std::move(*static_cast<C *>(component)));
+	}
+
+	template<typename C> static void copyConstructImpl(void *destination, const void *source) {
+		new (destination) C(*static_cast<const C *>(source));
+	}
+
+	template<typename C> static void copyTrivialImpl(void *destination, const void *source) {
+		std::memcpy(destination, source, sizeof(C));
+	}
+
+	using CopyConstruct = void (*)(void *destination, const void *source);
+
+	// chosen by whether the type is trivially copyable, then by whether it's copy constructible at all
+	template<typename C> static CopyConstruct getCopyConstruct(std::true_type, std::true_type) {
+		return &copyTrivialImpl<C>;
+	}
+
+	template<typename C> static CopyConstruct getCopyConstruct(std::false_type, std::true_type) {
+		return &copyConstructImpl<C>;
+	}
+
+	template<typename C, typename Trivial> static CopyConstruct getCopyConstruct(Trivial, std::false_type) {
+		return nullptr;
+	}
+
+	template<typename C> static Operations makeOperations(std::true_type) {
+		return Operations { sizeof(C), alignof(C), &moveConstructImpl<C>, &destroyImpl<C>, &deleteHeapImpl<C>,
+		        &moveToHeapImpl<C>,
+		        getCopyConstruct<C>(std::is_trivially_copyable<C>(), std::is_copy_constructible<C>()) };
+	}
+
+	template<typename C> static Operations makeOperations(std::false_type) {
+		return Operations { sizeof(C), alignof(C), nullptr, &destroyImpl<C>, &deleteHeapImpl<C>, nullptr,
+		        getCopyConstruct<C>(std::is_trivially_copyable<C>(), std::is_copy_constructible<C>()) };
+	}
 };
 }
 
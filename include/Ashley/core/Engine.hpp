@@ -17,22 +17,37 @@
 #ifndef ACPP_CORE_ENGINE_HPP_
 #define ACPP_CORE_ENGINE_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <typeindex>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Archetype.hpp"
 #include "Ashley/core/Entity.hpp"
+#include "Ashley/core/EntityHandle.hpp"
 #include "Ashley/core/EntitySystem.hpp"
 #include "Ashley/core/EntityListener.hpp"
 #include "Ashley/core/Family.hpp"
+#include "Ashley/core/Prefab.hpp"
+#include "Ashley/core/View.hpp"
+#include "Ashley/internal/ArchetypeStorage.hpp"
+#include "Ashley/internal/ChangeTicks.hpp"
+#include "Ashley/internal/CommandBuffer.hpp"
+#include "Ashley/internal/ComponentMasks.hpp"
 #include "Ashley/internal/ComponentOperations.hpp"
+#include "Ashley/internal/FamilyMembers.hpp"
+#include "Ashley/internal/SystemScheduler.hpp"
 #include "Ashley/signals/Listener.hpp"
 #include "Ashley/signals/Signal.hpp"
 #include "Ashley/util/ObjectPools.hpp"
+#include "Ashley/util/ThreadPool.hpp"
 
 namespace ashley {
 class Component;
@@ -58,6 +73,10 @@ class Family;
  * </ul>
  * </p>
  *
+ * <p>By default every {@link Component} is allocated individually. An Engine constructed with
+ * {@link StorageMode#ARCHETYPE} instead stores the components of entities with the same set of components together in
+ * contiguous chunks; see {@link Archetype}.</p>
+ *
  * <p>Engine has copy construction deleted but allows move construction and assignment. As of the first release,
  * allowing copy construction probably wouldn't break anything, but supporting copy construction might be expensive
  * in the future if more memory management is required.</p>
@@ -67,7 +86,18 @@ class Family;
  */
 class Engine {
 public:
-	Engine();
+	/**
+	 * <p>Describes how the {@link Component}s of entities added to an {@link Engine} are stored.</p>
+	 */
+	enum class StorageMode {
+		/** Each component is individually allocated and owned by its {@link Entity}. */
+		HEAP,
+
+		/** Components are stored contiguously by {@link Archetype}. */
+		ARCHETYPE
+	};
+
+	explicit Engine(StorageMode storageMode = StorageMode::HEAP);
 
 	~Engine();
 
@@ -85,28 +115,137 @@ public:
 	 * and trying to use the value you moved in is undefined behaviour
 	 * (and probably a segfault).</p>
 	 *
+	 * <p>During {@link #update(float)} the entity is only added once the systems have finished, so until then it has
+	 * no handle and belongs to no families.</p>
+	 *
 	 * @return a (safe-to-use) naked pointer to the {@link Entity} in the {@link Engine}.
 	 */
 	Entity *addEntity(std::unique_ptr<Entity> &&ptr);
 
 	/**
 	 * <p>Constructs a new {@link Entity} owned by this {@link Engine} and returns a pointer to it.</p>
+	 * <p>Entities are allocated in blocks and recycled once removed, so adding an entity doesn't normally allocate.</p>
+	 * <p>During {@link #update(float)} the entity is only added once the systems have finished, so until then it has
+	 * no handle and belongs to no families. Components can be added to it straight away.</p>
 	 * @return a pointer to the created {@link Entity}.
 	 */
 	Entity *addEntity();
 
+	/**
+	 * <p>Constructs <em>count</em> new {@link Entity}s owned by this {@link Engine}, each with a default constructed
+	 * {@link Component} of every type in C. Each entity is then passed to <em>initializer(Entity &entity,
+	 * std::size_t i)</em>, where it can have its components set up or more components added, before any of them are
+	 * added to the engine.</p>
+	 *
+	 * <p>Much cheaper than adding the entities one by one: storage is reserved once, entities with the same components
+	 * as the one before them reuse its family matches, and listeners are notified once for the whole batch through
+	 * {@link EntityListener#entitiesAdded}.</p>
+	 *
+	 * <p>During {@link #update(float)} the entities are only added once the systems have finished, as with
+	 * {@link #addEntity()}.</p>
+	 */
+	template<typename ...C, typename F> void addEntities(std::size_t count, F &&initializer) {
+		std::vector<Entity *> added;
+		obtainEntities(count, added);
+
+		for (std::size_t i = 0u; i < count; ++i) {
+			auto &entity = *added[i];
+
+			// the entities aren't in the engine yet, so adding components doesn't match families
+			entity.components.reserve(sizeof...(C));
+			const int expand[] = { 0, (entity.template add<C>(), 0)... };
+			(void) expand;
+
+			initializer(entity, i);
+		}
+
+		addEntitiesInternal(added);
+	}
+
+	/**
+	 * <p>As above, without an initializer.</p>
+	 */
+	template<typename ...C> void addEntities(std::size_t count) {
+		addEntities<C...>(count, [](Entity &, std::size_t) {});
+	}
+
+	/**
+	 * <p>Constructs a new {@link Entity} owned by this {@link Engine} with a copy of every component in the
+	 * {@link Prefab}.</p>
+	 * @return a pointer to the created {@link Entity}, which is only added once the systems have finished if this is
+	 * 		   called during {@link #update(float)}.
+	 */
+	Entity *instantiate(const Prefab &prefab);
+
+	/**
+	 * <p>Constructs <em>count</em> copies of the {@link Prefab}, passing each to <em>initializer(Entity &entity,
+	 * std::size_t i)</em> before adding them all as with {@link #addEntities}. Since every copy starts with the same
+	 * components, families are only matched once unless the initializer changes them.</p>
+	 *
+	 * <p>With archetype storage each copy's components are written straight into their archetype's columns. Otherwise,
+	 * or during {@link #update(float)}, each component is cloned separately from its type's pool.</p>
+	 */
+	template<typename F> void instantiate(const Prefab &prefab, std::size_t count, F &&initializer) {
+		std::vector<Entity *> added;
+		obtainEntities(count, added);
+		copyPrefab(prefab, added);
+
+		for (std::size_t i = 0u; i < count; ++i) {
+			initializer(*added[i], i);
+		}
+
+		addEntitiesInternal(added);
+	}
+
+	/**
+	 * <p>As above, without an initializer.</p>
+	 */
+	void instantiate(const Prefab &prefab, std::size_t count);
+
+	/**
+	 * <p>Resolves a handle issued by this {@link Engine} in constant time.</p>
+	 * @return the {@link Entity} referred to by the handle, or nullptr if it has been removed or the handle is null.
+	 */
+	inline Entity *getEntity(EntityHandle handle) const {
+		return handle.index < entitySlots.size() && entitySlots[handle.index].generation == handle.generation ?
+		        entitySlots[handle.index].entity : nullptr;
+	}
+
+	/**
+	 * @return true if the handle refers to an {@link Entity} which is still in this {@link Engine}.
+	 */
+	inline bool isValid(EntityHandle handle) const {
+		return getEntity(handle) != nullptr;
+	}
+
 	/**
 	 * <p>Removes an {@link Entity} from this {@link Engine} via a pointer to the {@link Entity}.</p>
 	 *
-	 * <p>Note that the {@link Entity} (and therefore all attached {@link Component}s) will be destroyed.</p>
+	 * <p>Note that the {@link Entity} (and therefore all attached {@link Component}s) will be destroyed, or reset
+	 * and kept for reuse if it was created by {@link #addEntity()}.</p>
 	 */
 	void removeEntity(Entity *const ptr);
 
 	/**
-	 * Removes all entities registered with this Engine.
+	 * <p>Removes every {@link Entity} in the list in a single pass, notifying listeners once through
+	 * {@link EntityListener#entitiesRemoved}. Entities which aren't in this engine are ignored.</p>
+	 *
+	 * <p>During {@link #update(float)} removal is deferred until the systems have finished, as with
+	 * {@link #removeEntity(Entity *)}.</p>
+	 */
+	void removeEntities(const std::vector<Entity *> &removed);
+
+	/**
+	 * <p>Removes all entities registered with this Engine in linear time, notifying listeners once.</p>
 	 */
 	void removeAllEntities();
 
+	/**
+	 * <p>Removes every {@link Entity} which belongs to the given {@link Family} in linear time, notifying listeners
+	 * once. The family is registered with this engine if it wasn't already.</p>
+	 */
+	void removeEntitiesFor(Family *family);
+
 	/**
 	 * Adds the {@link EntitySystem} to this Engine via a std::unique_ptr with moving.
 	 *
@@ -171,6 +310,84 @@ public:
 	 */
 	std::vector<Entity *> *getEntitiesFor(Family *family);
 
+	/**
+	 * @return the storage mode this {@link Engine} was constructed with.
+	 */
+	inline StorageMode getStorageMode() const {
+		return storageMode;
+	}
+
+	/**
+	 * <p>Returns every {@link Archetype} whose entities match the given {@link Family}, allowing their components to
+	 * be processed chunk by chunk. Note that this creates and populates a new vector.</p>
+	 * @return the matching archetypes; always empty unless the storage mode is {@link StorageMode#ARCHETYPE}.
+	 */
+	std::vector<Archetype *> getArchetypesFor(Family *family) const;
+
+	/**
+	 * <p>Returns a {@link View} of the entities which have all of the given components, for iterating over the
+	 * components directly. Component types which are only read can be given as const. The view's family is registered
+	 * with this engine if it wasn't already, which is safe from systems updated in parallel.</p>
+	 */
+	template<typename ...C> View<C...> view() {
+		auto family = Family::getFor<typename std::remove_const<C>::type...>();
+		return View<C...>(getFamilyMembers(family), archetypeStorage.get(), &changeTicks, changeTick);
+	}
+
+	/**
+	 * <p>Starts recording when components of the given type change, so that they can be found with
+	 * {@link View#changedSince}. A component counts as changed when it's added, when
+	 * {@link Entity#markChanged} is called for it, or when a {@link View} which doesn't declare it as const passes it
+	 * to a function. Components which already exist count as changed at the current tick.</p>
+	 *
+	 * <p>Untracked component types cost nothing. Must not be called during {@link #update(float)}.</p>
+	 */
+	template<typename C> void trackChanges() {
+		trackChanges(ComponentType::getIndexFor<C>());
+	}
+
+	void trackChanges(uint64_t componentIndex);
+
+	/**
+	 * @return true if changes to components of the given type are recorded; see {@link #trackChanges}.
+	 */
+	template<typename C> bool isTrackingChanges() const {
+		return changeTicks.isTracked(ComponentType::getIndexFor<C>());
+	}
+
+	/**
+	 * <p>Returns the engine's current change tick, which is advanced at the start of every {@link #update(float)}.
+	 * Every change recorded until the next update is given this tick, so a system which stores the tick when it
+	 * updates and passes it to {@link View#changedSince} the next time sees every change made in between.</p>
+	 */
+	inline uint64_t getChangeTick() const {
+		return changeTick;
+	}
+
+	/**
+	 * <p>When enabled, adding or removing a {@link Component} no longer updates family membership straight away.
+	 * Instead the {@link Entity} is marked as dirty and its families are re-evaluated once, however many of its
+	 * components changed, when {@link #updateFamilies()} is called. This happens automatically after component
+	 * operations are processed at the end of {@link #update(float)}.</p>
+	 *
+	 * <p>While enabled, the vectors returned by {@link #getEntitiesFor(Family*)} may be stale for entities whose
+	 * components were changed since the last update. Disabling deferral updates all pending entities immediately.</p>
+	 */
+	void setDeferFamilyUpdates(bool deferFamilyUpdates);
+
+	/**
+	 * @return true if family membership updates are deferred; see {@link #setDeferFamilyUpdates(bool)}.
+	 */
+	inline bool getDeferFamilyUpdates() const {
+		return deferFamilyUpdates;
+	}
+
+	/**
+	 * <p>Re-evaluates family membership for every {@link Entity} whose components have changed while family updates
+	 * were deferred. Does nothing if no entities are pending.</p>
+	 */
+	void updateFamilies();
+
 	/**
 	 * Adds an {@link EntityListener}.
 	 */
@@ -181,6 +398,38 @@ public:
 	 */
 	void removeEntityListener(ashley::EntityListener *listener);
 
+	/**
+	 * @return true while {@link #update(float)} is running, when entity additions and removals and component
+	 * 		   operations are deferred until the systems have finished.
+	 */
+	inline bool isUpdating() const {
+		return updating;
+	}
+
+	/**
+	 * <p>Sets the number of worker threads used to update systems. With 0 threads, the default, systems are updated one
+	 * after another on the calling thread. Otherwise, systems which have declared their component access and don't
+	 * conflict are updated at the same time; see {@link EntitySystem#declareReads(const BitsType &)}.</p>
+	 *
+	 * <p>Must not be called during {@link #update(float)}.</p>
+	 */
+	void setThreadCount(std::size_t threadCount);
+
+	/**
+	 * @return the number of worker threads used to update systems.
+	 */
+	inline std::size_t getThreadCount() const {
+		return threadPool == nullptr ? 0u : threadPool->getThreadCount();
+	}
+
+	/**
+	 * @return the pool used to update systems, which systems can also use for their own work, or nullptr if the
+	 * 		   thread count is 0.
+	 */
+	inline ThreadPool *getThreadPool() const {
+		return threadPool.get();
+	}
+
 	/**
 	 * Updates all the systems in this Engine.
 	 * @param deltaTime The time passed since the last frame.
@@ -191,8 +440,28 @@ public:
 										 const std::unique_ptr<EntitySystem> &other);
 
 private:
-	std::vector<std::unique_ptr<Entity>> entities;
-	std::unordered_map<Family, std::vector<Entity *>> families;
+	StorageMode storageMode;
+	std::unique_ptr<internal::ArchetypeStorage> archetypeStorage;
+
+	struct EntitySlot {
+		Entity *entity;
+		uint32_t generation;
+	};
+
+	// entities created by addEntity() come from entityPool; any others are owned here and deleted on removal
+	SlabPool<Entity> entityPool;
+	std::vector<Entity *> entities;
+
+	// the component bits of each entity in entities, at the same positions, for matching new families in bulk
+	internal::ComponentMasks componentMasks;
+
+	// indexed by the engine's dense family id, assigned in the order families are first requested from this engine
+	std::vector<std::unique_ptr<internal::FamilyMembers>> families;
+	std::unordered_map<const Family *, internal::FamilyMembers *> familiesByPointer;
+
+	// indexed by EntityHandle::index; freed slots are recycled with a new generation
+	std::vector<EntitySlot> entitySlots;
+	std::vector<uint32_t> freeEntitySlots;
 
 	std::vector<std::unique_ptr<EntitySystem>> systems;
 	std::unordered_map<std::type_index, EntitySystem *> systemsByClass;
@@ -200,57 +469,177 @@ private:
 	std::vector<ashley::EntityListener *> listeners;
 	std::vector<ashley::EntityListener *> removalPendingListeners;
 
-	std::vector<Entity *> pendingRemovalEntities;
-
 	bool notifying;
 	bool updating;
+	bool deferFamilyUpdates;
+
+	// true while systems are being updated, possibly on several threads
+	bool runningSystems;
+
+	// structural changes made by each system during an update, at the same positions as systems
+	std::vector<internal::CommandBuffer> commandBuffers;
 
-	ObjectPool<ComponentOperation> operationPool;
-	std::vector<ComponentOperation *> operationVector;
+	// structural changes made during an update from threads with no current command buffer for this engine, applied
+	// after those of every system; their order across threads depends on timing
+	internal::CommandBuffer sharedCommands;
+
+	// reused when adding and removing the entities queued in each command buffer
+	std::vector<Entity *> addedBatch;
+	std::vector<Entity *> removedBatch;
+
+	// the tick given to changes to tracked component types; starts above 0 so that no change has tick 0
+	uint64_t changeTick = 1u;
+	internal::ChangeTicks changeTicks;
+
+	// guards sharedCommands and entityPool during an update
+	std::unique_ptr<std::mutex> deferredMutex;
+
+	// families first requested while systems are running, registered once they've finished; guarded by familyMutex
+	std::vector<std::unique_ptr<internal::FamilyMembers>> pendingFamilies;
+	std::unique_ptr<std::mutex> familyMutex;
+
+	std::unique_ptr<ThreadPool> threadPool;
+	std::unique_ptr<internal::SystemScheduler> systemScheduler;
+
+	/**
+	 * @return true if the entity is owned by this engine, found in constant time via the entity's stored index.
+	 */
+	inline bool ownsEntity(const ashley::Entity &entity) const {
+		return entity.engineIndex < entities.size() && entities[entity.engineIndex] == &entity;
+	}
+
+	// for each component index, the registered families whose all, one or exclude bits mention that component
+	std::vector<std::vector<internal::FamilyMembers *>> familiesByComponent;
+
+	// registered families which mention no components in all or one; these can change on any component change
+	std::vector<internal::FamilyMembers *> unindexedFamilies;
+
+	struct DirtyEntity {
+		EntityHandle handle;
+		BitsType changedComponents;
+	};
+
+	// entities whose families need re-evaluating; each entity appears at most once, see Entity::dirtyIndex
+	std::vector<DirtyEntity> dirtyEntities;
+
+	// reused when collecting the families affected by a set of changed components
+	std::vector<internal::FamilyMembers *> affectedFamilies;
+
+	/**
+	 * Called by an {@link Entity} when one of its components was added or removed.
+	 */
+	void componentChanged(ashley::Entity &entity, uint64_t componentIndex);
+
+	/**
+	 * Called by an {@link Entity} when several of its components were added or removed at once.
+	 */
+	void componentsChanged(ashley::Entity &entity, const BitsType &changedComponents);
+
+	DirtyEntity &markDirty(ashley::Entity &entity);
+
+	/**
+	 * @return the members of the given family, registering the family if it wasn't already. Families first requested
+	 * 		   while systems are running are only registered once every system has finished.
+	 */
+	internal::FamilyMembers &getFamilyMembers(Family *family);
+
+	/**
+	 * @return the members of a new family, found by matching every entity's component bits.
+	 */
+	std::unique_ptr<internal::FamilyMembers> createFamilyMembers(const Family &family, std::size_t id) const;
+
+	/**
+	 * Adds the members of a new family to the engine and indexes the family by the components it mentions.
+	 */
+	internal::FamilyMembers &registerFamily(std::unique_ptr<internal::FamilyMembers> &&members);
+
+	void registerPendingFamilies();
 
 	void updateFamilyMembership(ashley::Entity &entity);
 
-	void processComponentOperations();
+	/**
+	 * Only re-evaluates the families which could be affected by a change to any of the given components, evaluating
+	 * each family at most once.
+	 */
+	void updateFamilyMembership(ashley::Entity &entity, const BitsType &changedComponents);
 
-	void removePendingListeners();
+	/**
+	 * Only re-evaluates the families which could be affected by a change to the given component.
+	 */
+	void updateFamilyMembership(ashley::Entity &entity, uint64_t componentIndex);
+
+	void updateFamilyMembership(ashley::Entity &entity, internal::FamilyMembers &members);
 
-	void removePendingEntities();
+	/**
+	 * Fills affectedFamilies with every family which mentions one of the given components, each appearing once.
+	 */
+	void collectAffectedFamilies(const BitsType &components, bool includeUnindexed);
+
+	void indexFamily(internal::FamilyMembers &members);
+
+	/**
+	 * Returns the calling thread's current command buffer, or locks sharedCommands and returns that.
+	 */
+	internal::CommandBuffer &getCommandBuffer(std::unique_lock<std::mutex> &lock);
+
+	/**
+	 * Applies every command buffer in order: first all added entities, then all component operations, then all
+	 * removals. Changes queued while applying are applied too.
+	 */
+	void processCommandBuffers();
+
+	void processComponentOperations(internal::CommandBuffer &buffer);
+
+	void removePendingListeners();
 
 	void removeEntityInternal(Entity *entity);
 
-	friend class AddedListener;
+	void removeEntityBatch(const std::vector<Entity *> &removed);
 
-	friend class RemovedListener;
+	/**
+	 * Removes an entity from its families and marks it as being removed, ready for listeners to be notified.
+	 */
+	void detachEntity(Entity &entity);
 
-	friend class EngineOperationHandler;
+	void removeFromFamilies(Entity &entity);
 
-	class AddedListener : public ashley::Listener<Entity> {
-	public:
-		AddedListener(Engine *engine) :
-				engine(engine) {
-		}
+	/**
+	 * Releases a detached entity's handle and position, then destroys it.
+	 */
+	void eraseEntity(Entity *entity);
 
-		virtual void receive(ashley::Signal<ashley::Entity> *signal, ashley::Entity *object) override {
-			engine->updateFamilyMembership(*object);
-		}
+	Entity *addEntityInternal(Entity *entity);
 
-	private:
-		Engine *engine = nullptr;
-	};
+	/**
+	 * Takes the given number of entities from the pool, locking it if an update is running.
+	 */
+	void obtainEntities(std::size_t count, std::vector<Entity *> &obtained);
 
-	class RemovedListener : public ashley::Listener<Entity> {
-	public:
-		RemovedListener(Engine *engine) :
-				engine(engine) {
-		}
+	/**
+	 * Adds a batch of entities at once, or queues them if an update is running.
+	 */
+	void addEntitiesInternal(const std::vector<Entity *> &added);
 
-		virtual void receive(ashley::Signal<ashley::Entity> *signal, ashley::Entity *object) override {
-			engine->updateFamilyMembership(*object);
-		}
+	void addEntityBatch(const std::vector<Entity *> &added);
 
-	private:
-		Engine *engine = nullptr;
-	};
+	/**
+	 * Copies the prefab's components onto entities which have none and aren't in the engine yet. Outside of updates,
+	 * archetype storage copies them straight into their archetype.
+	 */
+	void copyPrefab(const Prefab &prefab, const std::vector<Entity *> &entities);
+
+	/**
+	 * Returns an entity which has been removed to the pool, or deletes it if it didn't come from the pool.
+	 */
+	void destroyEntity(Entity *entity);
+
+	EntityHandle allocateHandle(Entity *entity);
+
+	void releaseHandle(EntityHandle handle);
+
+	friend class Entity;
+
+	friend class EngineOperationHandler;
 
 	class EngineOperationHandler : public ashley::ComponentOperationHandler {
 	public:
@@ -260,18 +649,16 @@ private:
 
 		~EngineOperationHandler() override = default;
 
-		void add(ashley::Entity *entity, std::unique_ptr<Component> &&component,
-				 const std::type_index typeIndex) override;
+		void add(ashley::Entity *entity, ComponentPtr &&component, uint64_t componentIndex) override;
+
+		void remove(ashley::Entity *entity, uint64_t componentIndex) override;
 
-		void remove(ashley::Entity *entity, std::type_index typeIndex) override;
+		void removeAll(ashley::Entity *entity) override;
 
 	private:
 		Engine *engine = nullptr;
 	};
 
-	std::unique_ptr<ashley::Listener<Entity>> componentAddedListener;
-	std::unique_ptr<ashley::Listener<Entity>> componentRemovedListener;
-
 	std::unique_ptr<EngineOperationHandler> operationHandler;
 };
 }
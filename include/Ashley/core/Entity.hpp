@@ -17,22 +17,33 @@
 #ifndef ACPP_CORE_ENTITY_HPP_
 #define ACPP_CORE_ENTITY_HPP_
 
-#include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <typeindex>
-#include <unordered_map>
 #include <vector>
 #include <type_traits>
 
 #include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Archetype.hpp"
 #include "Ashley/core/Component.hpp"
 #include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/EntityHandle.hpp"
 #include "Ashley/signals/Signal.hpp"
 #include "Ashley/internal/ComponentOperations.hpp"
+#include "Ashley/internal/ComponentPool.hpp"
 #include "Ashley/internal/Helper.hpp"
+#include "Ashley/util/ObjectPools.hpp"
 
 namespace ashley {
+class Engine;
+
+template<typename T> class ComponentMapper;
+template<typename ...C> class View;
+
+namespace internal {
+class ArchetypeStorage;
+}
 
 /**
  * Simple containers of {@link Component}s that hold data. The component's data
@@ -42,10 +53,14 @@ namespace ashley {
  * functions are called, depending on whether or not a component operation
  * handler is in effect.
  *
+ * When the entity belongs to an {@link Engine} in archetype storage mode, its components are stored in an
+ * {@link Archetype} rather than individually, and pointers to them are only valid until the next component is added
+ * to or removed from any entity in that engine.
+ *
  * <em>Java author: Stefan Bachmann</em>
  * @author Ashley Davis (SgtCoDFish)
  */
-class Entity {
+class Entity : public ashley::Poolable {
 public:
 	/** A flag that can be used to bit mask this entity. Up to the user to manage. */
 	uint64_t flags = 0;
@@ -61,7 +76,7 @@ public:
 	 */
 	Entity();
 
-	~Entity() = default;
+	~Entity() override;
 
 	// Owns resources so remove copy constructors.
 	Entity(Entity &&other) = default;
@@ -81,13 +96,16 @@ public:
 	 */
 	template<typename C> Entity &add(std::unique_ptr<C> &&component) {
 		internal::verify_component_type<C>();
+		ashley::ComponentType::getFor<C>();
 
-		auto typeIndex = std::type_index(typeid(C));
+		const auto componentIndex = ashley::ComponentType::getIndexFor<C>();
+		ComponentPtr owned(component.release(),
+		        ComponentDeleter(ashley::ComponentType::getFor<C>().getOperations().deleteHeap));
 
 		if (operationHandler != nullptr) {
-			operationHandler->add(this, std::move(component), typeIndex);
+			operationHandler->add(this, std::move(owned), componentIndex);
 		} else {
-			addInternal(std::move(component), typeIndex);
+			addInternal(std::move(owned), componentIndex);
 		}
 
 		return *this;
@@ -102,28 +120,27 @@ public:
 	 */
 	template<typename C, typename ...Args> Entity &add(Args&&... args) {
 		internal::verify_component_type<C>();
+		ashley::ComponentType::getFor<C>();
 
-		const auto typeIndex = std::type_index(typeid(C));
-		auto component = std::unique_ptr<Component>(new C(args...));
+		const auto componentIndex = ashley::ComponentType::getIndexFor<C>();
+		auto component = internal::makeComponent<C>(std::forward<Args>(args)...);
 
 		if (operationHandler != nullptr) {
-			operationHandler->add(this, std::move(component), typeIndex);
+			operationHandler->add(this, std::move(component), componentIndex);
 		} else {
-			addInternal(std::move(component), typeIndex);
+			addInternal(std::move(component), componentIndex);
 		}
 
 		return *this;
-
-//		return add<C>(std::unique_ptr<C>(new C(args...)));
 	}
 
 	/**
 	 * <p>Removes a {@link Component} by its type_index.</p>
 	 * @param typeIndex the type index of the component to remove
-	 * @return the removed {@link Component}'s unique_ptr if the component was removed straight away; or nullptr if not
-	 * found or if the removal has been delayed (e.g. when we're already in update() and need to wait to the end)
+	 * @return the removed {@link Component} if it was removed straight away; or nullptr if not found or if the removal
+	 * has been delayed (e.g. when we're already in update() and need to wait to the end)
 	 */
-	std::unique_ptr<Component> remove(const std::type_index typeIndex);
+	ComponentPtr remove(const std::type_index typeIndex);
 
 	/**
 	 * <p>Removes the {@link Component} of the specified type. Since there is only ever one component of one type, we
@@ -134,11 +151,7 @@ public:
 		const auto typeID = ashley::ComponentType::getIndexFor<C>();
 
 		if (componentBits[typeID] == true) {
-			const auto typeIndex = std::type_index(typeid(C));
-
-			std::unique_ptr<Component> c = remove(typeIndex);
-
-			return std::unique_ptr<C>(static_cast<C*>(c.release()));
+			return internal::releaseToHeap<C>(removeImpl(typeID));
 		} else {
 			return std::unique_ptr<C>(nullptr);
 		}
@@ -146,7 +159,8 @@ public:
 
 	/**
 	 * <p>Removes all the {@link Component}'s from the Entity.</p>
-	 * <p>Note that they'll all be destroyed and unretrievable by doing this.</p>
+	 * <p>Note that they'll all be destroyed and unretrievable by doing this. As with {@link #remove}, the removal is
+	 * deferred if this Entity is in an {@link Engine} which is updating.</p>
 	 */
 	void removeAll();
 
@@ -160,10 +174,19 @@ public:
 	std::vector<Component *> getComponents() const;
 
 	/**
-	 * @return The Entity's unique index.
+	 * @return The Entity's index, unique among the entities in the same {@link Engine}. This is the packed value of
+	 * {@link Entity#getHandle}, and is 0 for an entity which isn't in an engine.
 	 */
 	inline uint64_t getIndex() const {
-		return index;
+		return handle.getId();
+	}
+
+	/**
+	 * @return The handle issued to this Entity by the {@link Engine} it was added to, or a null handle if the Entity
+	 * isn't in an engine.
+	 */
+	inline EntityHandle getHandle() const {
+		return handle;
 	}
 
 	/**
@@ -173,19 +196,38 @@ public:
 	template<typename C> C* getComponent() {
 		internal::verify_component_type<C>();
 
-		auto type = std::type_index(typeid(C));
-		auto id = ashley::ComponentType::getIndexFor(type);
-
-		return (componentBits[id] ? (C *) (componentMap[type].get()) : nullptr);
+		return (C *) getComponentByIndex(ashley::ComponentType::getIndexFor<C>());
 	}
 
 	/**
 	 * @return Whether or not the {@link Entity} already has a {@link Component} of the specified type.
 	 */
 	template<typename C> bool hasComponent() const {
-		return componentBits[ashley::ComponentType::getIndexFor(std::type_index(typeid(C)))];
+		return componentBits[ashley::ComponentType::getIndexFor<C>()];
+	}
+
+	/**
+	 * <p>Records that this Entity's {@link Component} of the given type has changed, so that it's found by
+	 * {@link View#changedSince}. Does nothing unless the Entity has such a component and is in an {@link Engine}
+	 * which tracks changes to its type; see {@link Engine#trackChanges}.</p>
+	 */
+	template<typename C> void markChanged() {
+		markChanged(ashley::ComponentType::getIndexFor<C>());
+	}
+
+	void markChanged(uint64_t componentIndex);
+
+	/**
+	 * @return the {@link Engine} change tick at which this Entity's {@link Component} of the given type last changed,
+	 * 		   or 0 if the Entity has no such component, isn't in an engine or the engine doesn't track changes to
+	 * 		   the type.
+	 */
+	template<typename C> uint64_t getChangeTick() const {
+		return getChangeTick(ashley::ComponentType::getIndexFor<C>());
 	}
 
+	uint64_t getChangeTick(uint64_t componentIndex) const;
+
 	/**
 	 * @return A const reference to this Entity's component bits, describing all the {@link Component}s it contains.
 	 */
@@ -195,16 +237,14 @@ public:
 	 * @return The number of components attached to this {@link Entity}.
 	 */
 	inline unsigned int countComponents() const {
-		return componentMap.size();
+		return componentBits.count();
 	}
 
 	/**
-	 * @return a bitset used for checking the membership of this {@link Entity} in various {@link Family}s.
-	 * Used internally; change at your peril.
+	 * <p>Destroys all of this Entity's components without notifying anything, and returns it to the state of a newly
+	 * created Entity. Called by an {@link Engine} before reusing an Entity it allocated itself.</p>
 	 */
-	inline ashley::BitsType &getFamilyBits() {
-		return familyBits;
-	}
+	void reset() override;
 
 	/**
 	 * Turn off/back on the component operation handler. This may have correctness implications;
@@ -233,54 +273,98 @@ public:
 		}
 	}
 
+	/**
+	 * Two entities are equal if they have the same handle. Entities which aren't in an engine have no handle and are
+	 * only equal to themselves.
+	 */
 	bool operator==(const ashley::Entity &other) const {
-		return this->index == other.index;
+		return this->handle == other.handle && (!this->handle.isNull() || this == &other);
 	}
 
 	bool operator!=(const ashley::Entity &other) const {
-		return this->index != other.index;
+		return !(*this == other);
 	}
 
 	bool operator<(const ashley::Entity &other) const {
-		return this->index < other.index;
+		return this->getIndex() < other.getIndex();
 	}
 
 	bool operator<=(const ashley::Entity &other) const {
-		return this->index <= other.index;
+		return this->getIndex() <= other.getIndex();
 	}
 
 	bool operator>(const ashley::Entity &other) const {
-		return this->index > other.index;
+		return this->getIndex() > other.getIndex();
 	}
 
 	bool operator>=(const ashley::Entity &other) const {
-		return this->index >= other.index;
+		return this->getIndex() >= other.getIndex();
 	}
 private:
-	static uint64_t nextIndex;
-
-	uint64_t index;
+	EntityHandle handle;
 
-	std::unordered_map<std::type_index, std::unique_ptr<Component>> componentMap;
+	// individually allocated components, ordered by component index; see getComponentSlot
+	std::vector<ComponentPtr> components;
 
 	ashley::BitsType componentBits;
-	ashley::BitsType familyBits;
 
 	ComponentOperationHandler *operationHandler = nullptr, *operationHandlerTemp = nullptr;
 
-	void addInternal(std::unique_ptr<Component> &&component, std::type_index type);
+	// the engine this entity belongs to, which is told directly about component changes
+	Engine *engine = nullptr;
+
+	// position of this entity in its engine's entity list; only meaningful while the entity is in an engine
+	std::size_t engineIndex = 0u;
 
-	std::unique_ptr<Component> removeImpl(std::type_index typeIndex);
+	// one past this entity's position in its engine's list of entities awaiting family re-evaluation, or 0 if clean
+	std::size_t dirtyIndex = 0u;
+
+	// set when the entity was allocated from its engine's pool, which recycles it on removal instead of deleting it
+	bool pooled = false;
+
+	// set while the entity's components live in archetype storage rather than in components
+	internal::ArchetypeStorage *storage = nullptr;
+	ashley::Archetype *archetype = nullptr;
+	std::size_t archetypeRow = 0u;
+
+	/**
+	 * @return the position in components of the component with the given index, which is the number of components
+	 * 		   this entity has with a lower index.
+	 */
+	inline std::size_t getComponentSlot(uint64_t componentIndex) const {
+		return componentBits.countBelow(componentIndex);
+	}
+
+	inline Component *getComponentByIndex(uint64_t componentIndex) const {
+		if (!componentBits[componentIndex]) {
+			return nullptr;
+		}
+
+		return archetype != nullptr ? static_cast<Component *>(archetype->getComponent(archetypeRow, componentIndex)) :
+		        components[getComponentSlot(componentIndex)].get();
+	}
+
+	void addInternal(ComponentPtr &&component, uint64_t componentIndex);
+
+	ComponentPtr removeImpl(uint64_t componentIndex);
 
 	/**
 	 * Actually processes the removal of a {@link Component} from this {@link Entity}.
-	 * @param componentType the component to remove
+	 * @param componentIndex the index of the component to remove
 	 * @return the component removed or nullptr if not removed
 	 */
-	std::unique_ptr<Component> removeInternal(std::type_index typeIndex);
+	ComponentPtr removeInternal(uint64_t componentIndex);
+
+	/**
+	 * Removes and destroys every component straight away, updating the engine's families once.
+	 */
+	void removeAllInternal();
 
 	friend class ComponentOperationHandler;
 	friend class Engine;
+	template<typename T> friend class ComponentMapper;
+	template<typename ...C> friend class View;
+	friend class internal::ArchetypeStorage;
 };
 
 }
@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_CORE_ENTITYHANDLE_HPP_
+#define ACPP_CORE_ENTITYHANDLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ashley {
+
+/**
+ * <p>A small, trivially copyable reference to an {@link Entity} in an {@link Engine}, made of a slot index and a
+ * generation. Slots are recycled when entities are removed, and the generation is bumped each time so that old
+ * handles to a removed entity can be detected; use {@link Engine#getEntity} to resolve a handle.</p>
+ *
+ * <p>Unlike a naked Entity pointer, a handle can safely be kept after the entity has been removed, so it's the
+ * preferred way for a {@link Component} to reference another entity.</p>
+ *
+ * <p>Handles are issued per-engine and the default constructed handle never refers to an entity.</p>
+ */
+struct EntityHandle {
+	uint32_t index;
+	uint32_t generation;
+
+	constexpr EntityHandle() :
+			        index(0u),
+			        generation(0u) {
+	}
+
+	constexpr EntityHandle(uint32_t index, uint32_t generation) :
+			        index(index),
+			        generation(generation) {
+	}
+
+	/**
+	 * @return true if this handle was never issued by an {@link Engine}.
+	 */
+	constexpr bool isNull() const {
+		return generation == 0u;
+	}
+
+	/**
+	 * @return the index and generation packed into a single value.
+	 */
+	constexpr uint64_t getId() const {
+		return (static_cast<uint64_t>(generation) << 32) | index;
+	}
+
+	constexpr bool operator==(const EntityHandle &other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	constexpr bool operator!=(const EntityHandle &other) const {
+		return !(*this == other);
+	}
+
+	constexpr bool operator<(const EntityHandle &other) const {
+		return getId() < other.getId();
+	}
+};
+
+static_assert(sizeof(EntityHandle) == sizeof(uint64_t), "EntityHandle should pack into 64 bits");
+
+}
+
+namespace std {
+/**
+ * <p>Overload of std::hash for EntityHandle, allowing handles to be used as keys in hash-based maps.</p>
+ */
+template<> struct hash<ashley::EntityHandle> {
+	std::size_t operator()(const ashley::EntityHandle &handle) const {
+		return std::hash<uint64_t>()(handle.getId());
+	}
+};
+}
+
+#endif /* ACPP_CORE_ENTITYHANDLE_HPP_ */
@@ -17,6 +17,8 @@
 #ifndef ACPP_CORE_ENTITYLISTENER_HPP_
 #define ACPP_CORE_ENTITYLISTENER_HPP_
 
+#include <vector>
+
 #include "Ashley/AshleyConstants.hpp"
 
 namespace ashley {
@@ -41,6 +43,27 @@ public:
 
 	virtual void entityAdded(ashley::Entity &entity) = 0;
 	virtual void entityRemoved(ashley::Entity &entity) = 0;
+
+	/**
+	 * <p>Called once for entities which were added together, e.g. by {@link Engine#addEntities}, after all of them have
+	 * been added. By default calls {@link #entityAdded} for each entity in order.</p>
+	 */
+	virtual void entitiesAdded(const std::vector<ashley::Entity *> &entities) {
+		for (auto entity : entities) {
+			entityAdded(*entity);
+		}
+	}
+
+	/**
+	 * <p>Called once for entities which were removed together, e.g. by {@link Engine#removeAllEntities}, after all of
+	 * them have left their families but before any are destroyed. By default calls {@link #entityRemoved} for each
+	 * entity in order.</p>
+	 */
+	virtual void entitiesRemoved(const std::vector<ashley::Entity *> &entities) {
+		for (auto entity : entities) {
+			entityRemoved(*entity);
+		}
+	}
 };
 }
 
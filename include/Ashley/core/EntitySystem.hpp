@@ -23,6 +23,7 @@
 #include <typeindex>
 
 #include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/ComponentType.hpp"
 
 namespace ashley {
 
@@ -92,6 +93,63 @@ public:
 		this->processing = processing;
 	}
 
+	/**
+	 * <p>Declares that this system reads the given {@link Component} types in {@link #update(float)}.</p>
+	 *
+	 * <p>Systems which declare their component access can be updated at the same time as other systems when the
+	 * {@link Engine} has worker threads; see {@link Engine#setThreadCount(std::size_t)}. Two systems conflict if either
+	 * writes a component the other reads or writes, and conflicting systems always run one after the other in priority
+	 * order. A system which declares nothing conflicts with every other system.</p>
+	 *
+	 * <p>A system which runs in parallel may change component values it has declared and add or remove components
+	 * or entities through the usual deferred operations, but must not change the {@link Engine}'s systems or
+	 * listeners. Deferred changes are applied in system priority order however the systems were scheduled.</p>
+	 */
+	void declareReads(const BitsType &bits) {
+		readBits |= bits;
+		accessDeclared = true;
+	}
+
+	/**
+	 * <p>Declares that this system writes the given {@link Component} types in {@link #update(float)}; see
+	 * {@link #declareReads(const BitsType &)}.</p>
+	 */
+	void declareWrites(const BitsType &bits) {
+		writeBits |= bits;
+		accessDeclared = true;
+	}
+
+	template<typename C, typename ...CRest> void declareReads() {
+		declareReads(ComponentType::getBitsFor<C, CRest...>());
+	}
+
+	template<typename C, typename ...CRest> void declareWrites() {
+		declareWrites(ComponentType::getBitsFor<C, CRest...>());
+	}
+
+	/**
+	 * @return true if this system has declared which components it reads or writes.
+	 */
+	inline bool hasDeclaredAccess() const {
+		return accessDeclared;
+	}
+
+	inline const BitsType &getReadBits() const {
+		return readBits;
+	}
+
+	inline const BitsType &getWriteBits() const {
+		return writeBits;
+	}
+
+	/**
+	 * @return true if this system and other can't safely be updated at the same time.
+	 */
+	inline bool conflictsWith(const EntitySystem &other) const {
+		return !accessDeclared || !other.accessDeclared || writeBits.intersects(other.readBits)
+		        || writeBits.intersects(other.writeBits) || readBits.intersects(other.writeBits);
+	}
+
 	/**
 	 * @return the polymorphic std::type_index corresponding to this {@link EntitySystem}.
 	 */
@@ -154,6 +212,10 @@ public:
 private:
 	bool processing;
 
+	bool accessDeclared = false;
+	BitsType readBits;
+	BitsType writeBits;
+
 	Engine * engine = nullptr;
 
 	void addedToEngineInternal(Engine &engine) {
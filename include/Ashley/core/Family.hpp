@@ -17,16 +17,17 @@
 #ifndef ACPP_CORE_FAMILY_HPP_
 #define ACPP_CORE_FAMILY_HPP_
 
-#include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <functional>
 #include <memory>
-#include <string>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 #include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/ComponentType.hpp"
 
 namespace ashley {
 
@@ -73,7 +74,17 @@ public:
 	 * @param exclude entities cannot contain any of the components in the set. See {@link ComponentType#getBitsFor}.
 	 * @return The family
 	 */
-	static Family *getFor(ashley::BitsType all, ashley::BitsType one, ashley::BitsType exclude);
+	static Family *getFor(const ashley::BitsType &all, const ashley::BitsType &one, const ashley::BitsType &exclude);
+
+	/**
+	 * <p>Returns the family matching entities which have all of the given {@link Component} types. The family is
+	 * looked up once per list of types and cached, so later calls cost no more than reading a pointer.</p>
+	 */
+	template<typename C, typename ...CRest> static Family *getFor() {
+		static Family * const family = getFor(ashley::ComponentType::getBitsFor<C, CRest...>(), ashley::BitsType(),
+		        ashley::BitsType());
+		return family;
+	}
 
 	/**
 	 * @return This family's unique index
@@ -82,11 +93,37 @@ public:
 		return index;
 	}
 
+	/**
+	 * @return the bits of the components an entity must have all of to match this family.
+	 */
+	inline const ashley::BitsType &getAll() const {
+		return all;
+	}
+
+	/**
+	 * @return the bits of the components an entity must have at least one of to match this family.
+	 */
+	inline const ashley::BitsType &getOne() const {
+		return one;
+	}
+
+	/**
+	 * @return the bits of the components an entity must not have any of to match this family.
+	 */
+	inline const ashley::BitsType &getExclude() const {
+		return exclude;
+	}
+
 	/**
 	 * @return Whether the entity matches the family requirements or not
 	 */
 	bool matches(ashley::Entity &entity) const;
 
+	/**
+	 * @return Whether a set of {@link Component}s described by the given bits matches the family requirements or not
+	 */
+	bool matches(const ashley::BitsType &componentBits) const;
+
 	/**
 	 * <p>Note that use_getFor_not_constructor is a private struct defined in Family; this means you cannot call this constructor and shouldn't try to.</p>
 	 * <p>Use the various getFor methods to retrieve Family instances, not this.</p>
@@ -113,10 +150,25 @@ public:
 	}
 
 private:
-	using FamilyHashType = std::string;
+	/**
+	 * Hashes the packed words of each set of bits without any allocation.
+	 */
+	static std::size_t hashBits(const BitsType &all, const BitsType &one, const BitsType &exclude) {
+		const std::hash<BitsType> bitsHash;
+		std::size_t result = bitsHash(all);
+
+		result ^= bitsHash(one) + 0x9e3779b97f4a7c15ull + (result << 6) + (result >> 2);
+		result ^= bitsHash(exclude) + 0x9e3779b97f4a7c15ull + (result << 6) + (result >> 2);
+
+		return result;
+	}
+
 	using internal_family_ptr = std::unique_ptr<Family>;
 	static uint64_t familyIndex;
-	static std::unordered_map<FamilyHashType, internal_family_ptr> families;
+
+	// keyed by hashBits, so that a lookup compares against each family's own bits rather than copying the given ones
+	// into a key; the bits are only copied when a new family is created
+	static std::unordered_multimap<std::size_t, internal_family_ptr> families;
 
 	BitsType all;
 	BitsType one;
@@ -124,14 +176,27 @@ private:
 
 	uint64_t index;
 
+	struct WordRequirement {
+		uint64_t all;
+		uint64_t one;
+		uint64_t exclude;
+	};
+
+	// the words of all, one and exclude side by side, up to the last word with any bit set in any of them, so that
+	// matching reads each word of an entity's bits once
+	std::vector<WordRequirement> requirements;
+	bool needsOne;
+
 	Family(ashley::BitsType all, ashley::BitsType one, ashley::BitsType exclude) :
 			        all(all),
 			        one(one),
 			        exclude(exclude),
-			        index(familyIndex++) {
+			        index(familyIndex++),
+			        needsOne(this->one.any()) {
+		buildRequirements();
 	}
 
-	static FamilyHashType getFamilyHash(ashley::BitsType all, ashley::BitsType one, ashley::BitsType exclude);
+	void buildRequirements();
 
 	// friend to allow hash function to be calculated
 	friend struct std::hash<ashley::Family>;
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_CORE_PREFAB_HPP_
+#define ACPP_CORE_PREFAB_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Ashley/core/Component.hpp"
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/internal/ComponentPool.hpp"
+#include "Ashley/internal/Helper.hpp"
+#include "Ashley/util/Bits.hpp"
+
+namespace ashley {
+class Engine;
+
+/**
+ * <p>A set of {@link Component}s with initial values, captured once and then copied onto as many new entities as
+ * needed with {@link Engine#instantiate}.</p>
+ *
+ * <p>Every instance has the same component bits, so the families it belongs to are only worked out once per batch.
+ * With {@link Engine::StorageMode#ARCHETYPE} instances are copied straight into their archetype's chunk arrays, using
+ * memcpy for trivially copyable components; otherwise each component is copied into memory from its type's pool.</p>
+ *
+ * <p>Components in a prefab must be copy constructible.</p>
+ */
+class Prefab {
+public:
+	Prefab() = default;
+	~Prefab() = default;
+
+	Prefab(const Prefab &other) = delete;
+	Prefab(Prefab &&other) = default;
+	Prefab& operator=(const Prefab &other) = delete;
+	Prefab& operator=(Prefab &&other) = default;
+
+	/**
+	 * <p>Constructs the initial value of a component of type C from <em>args...</em>, replacing any component of the
+	 * same type already in the prefab.</p>
+	 * @return this prefab for chaining.
+	 */
+	template<typename C, typename ...Args> Prefab &add(Args &&...args) {
+		internal::verify_component_type<C>();
+		static_assert(std::is_copy_constructible<C>(), "Prefab components must be copy constructible.");
+
+		addPrototype(ComponentType::getIndexFor<C>(), internal::makeComponent<C>(std::forward<Args>(args)...),
+		        &clonePrototype<C>);
+		return *this;
+	}
+
+	/**
+	 * @return the initial value of the component of type C, which can be changed to affect future instances, or
+	 * 		   nullptr if the prefab has no such component.
+	 */
+	template<typename C> C *getComponent() const {
+		return static_cast<C *>(getPrototype(ComponentType::getIndexFor<C>()));
+	}
+
+	template<typename C> bool hasComponent() const {
+		return componentBits[ComponentType::getIndexFor<C>()];
+	}
+
+	/**
+	 * @return the component bits every instance of this prefab starts with.
+	 */
+	inline const BitsType &getComponentBits() const {
+		return componentBits;
+	}
+
+	inline std::size_t countComponents() const {
+		return prototypes.size();
+	}
+
+private:
+	using Clone = ComponentPtr (*)(const Component &prototype);
+
+	struct Prototype {
+		uint64_t componentIndex;
+		ComponentPtr component;
+		Clone clone;
+	};
+
+	BitsType componentBits;
+
+	// ordered by component index, the same order entities keep their components in
+	std::vector<Prototype> prototypes;
+
+	void addPrototype(uint64_t componentIndex, ComponentPtr &&component, Clone clone);
+
+	Component *getPrototype(uint64_t componentIndex) const;
+
+	template<typename C> static ComponentPtr clonePrototype(const Component &prototype) {
+		return internal::makeComponent<C>(static_cast<const C &>(prototype));
+	}
+
+	friend class Engine;
+};
+}
+
+#endif /* ACPP_CORE_PREFAB_HPP_ */
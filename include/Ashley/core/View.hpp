@@ -0,0 +1,265 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_CORE_VIEW_HPP_
+#define ACPP_CORE_VIEW_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Archetype.hpp"
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/Entity.hpp"
+#include "Ashley/core/Family.hpp"
+#include "Ashley/internal/ArchetypeStorage.hpp"
+#include "Ashley/internal/ChangeTicks.hpp"
+#include "Ashley/internal/FamilyMembers.hpp"
+
+namespace ashley {
+
+/**
+ * <p>A typed view of every {@link Entity} in an {@link Engine} which has all of the given {@link Component}s, passing
+ * references to the components straight to a function rather than going through {@link Entity#getComponent} for
+ * each one.</p>
+ *
+ * <p>In archetype storage mode the components are read chunk by chunk from each matching {@link Archetype}'s
+ * arrays, so a simple loop body can be inlined and vectorised. In heap storage mode the view walks the family's
+ * entities, resolving each component by index.</p>
+ *
+ * <p>Component types can be given as const, as in <code>View&lt;const Position, Velocity&gt;</code>, to pass const
+ * references. When the engine tracks changes to a component type (see {@link Engine#trackChanges}), every
+ * non-const component of that type passed to a function is recorded as changed; declaring components which are only
+ * read as const avoids this. {@link #changedSince} gives a view of only the entities whose component changed since a
+ * tick.</p>
+ *
+ * <p>Views are cheap to create; get one from {@link Engine#view}. Adding or removing components or entities while
+ * iterating a view is only supported during {@link Engine#update}, when such changes are deferred.</p>
+ */
+template<typename ...C> class View {
+	static_assert(sizeof...(C) > 0, "a view needs at least one component type");
+
+public:
+	/**
+	 * @param members the engine's entities for the family matching every one of the view's components.
+	 * @param storage the engine's archetype storage, or nullptr in heap storage mode.
+	 * @param changeTicks the engine's component change ticks, or nullptr if changes aren't recorded.
+	 * @param changeTick the tick given to changes made through the view.
+	 */
+	View(internal::FamilyMembers &members, const internal::ArchetypeStorage *storage,
+	        internal::ChangeTicks *changeTicks = nullptr, uint64_t changeTick = 0u) :
+			        members(members),
+			        family(members.getFamily()),
+			        entities(members.getEntities()),
+			        storage(storage),
+			        changeTicks(changeTicks),
+			        changeTick(changeTick),
+			        marking(false),
+			        filtered(false),
+			        filterIndex(0u),
+			        filterTick(0u) {
+		if (changeTicks != nullptr) {
+			const bool tracked[] = { (!std::is_const<C>::value && changeTicks->isTracked(indexOf<C>()))... };
+
+			for (auto isTracked : tracked) {
+				marking = marking || isTracked;
+			}
+		}
+	}
+
+	~View() = default;
+	View(const View &other) = default;
+	View(View &&other) = default;
+	View& operator=(const View &other) = delete;
+	View& operator=(View &&other) = delete;
+
+	/**
+	 * @return the number of entities in the view, not counting any {@link #changedSince} filter.
+	 */
+	inline std::size_t size() const {
+		return entities.size();
+	}
+
+	inline const Family &getFamily() const {
+		return family;
+	}
+
+	/**
+	 * <p>Returns a view of only those entities whose component of type T changed at or after the given tick, as
+	 * returned by {@link Engine#getChangeTick}. T must be one of the view's component types, and the engine must
+	 * track changes to it.</p>
+	 */
+	template<typename T> View changedSince(uint64_t tick) const {
+		static_assert(Contains<typename std::remove_const<T>::type, typename std::remove_const<C>::type...>::value,
+		        "a view can only be filtered by one of its own component types");
+		assert(changeTicks != nullptr && changeTicks->isTracked(indexOf<T>()) && "changes to T aren't tracked");
+
+		View filteredView(*this);
+		filteredView.filtered = true;
+		filteredView.filterIndex = indexOf<T>();
+		filteredView.filterTick = tick;
+
+		return filteredView;
+	}
+
+	/**
+	 * <p>Calls <code>function(C &...)</code> with the components of every entity in the view.</p>
+	 */
+	template<typename F> void each(F &&function) const {
+		if (marking || filtered) {
+			eachTracked([&](Entity &, C &...components) {
+				function(components...);
+			});
+		} else if (storage != nullptr) {
+			forEachArchetype([&](std::size_t count, Entity * const *, C *...components) {
+				for (std::size_t i = 0u; i < count; i++) {
+					function(components[i]...);
+				}
+			});
+		} else {
+			for (auto entity : entities) {
+				function(get<C>(*entity)...);
+			}
+		}
+	}
+
+	/**
+	 * <p>Calls <code>function(Entity &, C &...)</code> with every entity in the view and its components.</p>
+	 */
+	template<typename F> void eachWithEntity(F &&function) const {
+		if (marking || filtered) {
+			eachTracked(function);
+		} else if (storage != nullptr) {
+			forEachArchetype([&](std::size_t count, Entity * const *chunkEntities, C *...components) {
+				for (std::size_t i = 0u; i < count; i++) {
+					function(*chunkEntities[i], components[i]...);
+				}
+			});
+		} else {
+			for (auto entity : entities) {
+				function(*entity, get<C>(*entity)...);
+			}
+		}
+	}
+
+private:
+	const internal::FamilyMembers &members;
+	const Family &family;
+	const std::vector<Entity *> &entities;
+	const internal::ArchetypeStorage *storage;
+
+	internal::ChangeTicks *changeTicks;
+	uint64_t changeTick;
+
+	// true if any non-const component type is tracked, so iterating records changes
+	bool marking;
+
+	bool filtered;
+	uint64_t filterIndex;
+	uint64_t filterTick;
+
+	template<typename T, typename ...Ts> struct Contains : std::false_type {
+	};
+
+	template<typename T, typename First, typename ...Rest> struct Contains<T, First, Rest...> : std::conditional<
+	        std::is_same<T, First>::value, std::true_type, Contains<T, Rest...>>::type {
+	};
+
+	template<typename T> static inline uint64_t indexOf() {
+		return ComponentType::getIndexFor<typename std::remove_const<T>::type>();
+	}
+
+	template<typename T> static inline T &get(const Entity &entity) {
+		return *static_cast<T *>(entity.getComponentByIndex(indexOf<T>()));
+	}
+
+	template<typename T> inline void mark(uint32_t slot) const {
+		if (!std::is_const<T>::value) {
+			changeTicks->mark(indexOf<T>(), slot, changeTick);
+		}
+	}
+
+	/**
+	 * Visits every entity passing the filter, one at a time, recording changes to its non-const components.
+	 */
+	template<typename F> void eachTracked(F &&function) const {
+		const auto visit = [&](Entity &entity, C &...components) {
+			const auto slot = entity.getHandle().index;
+
+			if (filtered && changeTicks->get(filterIndex, slot) < filterTick) {
+				return;
+			}
+
+			if (marking) {
+				const int expand[] = { (mark<C>(slot), 0)... };
+				(void) expand;
+			}
+
+			function(entity, components...);
+		};
+
+		if (filtered) {
+			const auto &ticks = changeTicks->getTicks(filterIndex);
+
+			// scanning the ticks is much cheaper per entity than checking the tick of each member, but it covers
+			// every entity in the engine so it's only worth it when the family isn't a small part of the engine
+			if (ticks.size() <= entities.size() * 8u) {
+				for (uint32_t slot = 0u; slot < ticks.size(); slot++) {
+					if (ticks[slot] >= filterTick) {
+						const auto entity = members.find(slot);
+
+						if (entity != nullptr) {
+							visit(*entity, get<C>(*entity)...);
+						}
+					}
+				}
+
+				return;
+			}
+		}
+
+		if (storage != nullptr) {
+			forEachArchetype([&](std::size_t count, Entity * const *chunkEntities, C *...components) {
+				for (std::size_t i = 0u; i < count; i++) {
+					visit(*chunkEntities[i], components[i]...);
+				}
+			});
+		} else {
+			for (auto entity : entities) {
+				visit(*entity, get<C>(*entity)...);
+			}
+		}
+	}
+
+	template<typename F> void forEachArchetype(F &&chunkFunction) const {
+		for (auto archetype : storage->getArchetypes()) {
+			if (archetype->size() == 0u || !family.matches(archetype->getComponentBits())) {
+				continue;
+			}
+
+			for (std::size_t chunk = 0u; chunk < archetype->getChunkCount(); chunk++) {
+				chunkFunction(archetype->getChunkSize(chunk), archetype->getEntities(chunk),
+				        archetype->getComponents<typename std::remove_const<C>::type>(chunk)...);
+			}
+		}
+	}
+};
+}
+
+#endif /* ACPP_CORE_VIEW_HPP_ */
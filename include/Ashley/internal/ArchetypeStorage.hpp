@@ -0,0 +1,106 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_ARCHETYPESTORAGE_HPP_
+#define ACPP_INTERNAL_ARCHETYPESTORAGE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Archetype.hpp"
+#include "Ashley/core/Component.hpp"
+
+namespace ashley {
+class Entity;
+
+namespace internal {
+
+/**
+ * <p>Owns every {@link Archetype} belonging to an {@link Engine} in archetype storage mode, and moves {@link Entity}s
+ * between archetypes as their {@link Component}s change.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class ArchetypeStorage {
+public:
+	explicit ArchetypeStorage(std::size_t chunkBytes);
+	~ArchetypeStorage() = default;
+
+	ArchetypeStorage(const ArchetypeStorage &other) = delete;
+	ArchetypeStorage(ArchetypeStorage &&other) = delete;
+	ArchetypeStorage& operator=(const ArchetypeStorage &other) = delete;
+	ArchetypeStorage& operator=(ArchetypeStorage &&other) = delete;
+
+	/**
+	 * @return the archetype for the given component bits, creating it if needed.
+	 */
+	Archetype *getArchetype(const BitsType &bits);
+
+	inline const std::vector<Archetype *> &getArchetypes() const {
+		return archetypeList;
+	}
+
+	/**
+	 * Moves all of the entity's individually allocated components into archetype storage.
+	 */
+	void insert(Entity &entity);
+
+	/**
+	 * Copies the given components, ordered by component index, into a new row for an entity which has no components
+	 * and isn't stored yet. The entity's component bits aren't changed.
+	 */
+	void insertCopy(Entity &entity, const BitsType &bits, const std::vector<const Component *> &sources);
+
+	/**
+	 * Destroys the entity's components and detaches it from this storage.
+	 */
+	void erase(Entity &entity);
+
+	/**
+	 * Adds or replaces a component on a stored entity, moving the entity to a new archetype if needed. Must be called
+	 * before the entity's component bits are updated.
+	 */
+	void add(Entity &entity, ComponentPtr &&component, uint64_t typeIndex);
+
+	/**
+	 * Removes a component from a stored entity, moving the entity to a new archetype. Must be called before the
+	 * entity's component bits are updated.
+	 * @return the removed component, moved into an individual allocation.
+	 */
+	ComponentPtr remove(Entity &entity, uint64_t typeIndex);
+
+	/**
+	 * Destroys all of a stored entity's components, moving it to the empty archetype.
+	 */
+	void removeAll(Entity &entity);
+
+private:
+	std::size_t chunkBytes;
+
+	std::unordered_map<BitsType, std::unique_ptr<Archetype>> archetypes;
+	std::vector<Archetype *> archetypeList;
+
+	void moveEntity(Entity &entity, Archetype *destination, uint64_t addedIndex, Component *added);
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_ARCHETYPESTORAGE_HPP_ */
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef ACPP_INTERNAL_CHANGETICKS_HPP_
+#define ACPP_INTERNAL_CHANGETICKS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+
+namespace ashley {
+namespace internal {
+
+/**
+ * <p>The tick at which each tracked {@link Component} of each {@link Entity} in an {@link Engine} last changed. Ticks
+ * are only kept for component types which have been tracked, with one array per type indexed by entity handle slot, so
+ * untracked types cost nothing and an entity keeps its ticks when its components move between archetypes.</p>
+ *
+ * <p>Only {@link #track} and {@link #markAll} resize the arrays, so {@link #mark} can be called from several threads
+ * at once for different entities.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class ChangeTicks {
+public:
+	ChangeTicks() = default;
+	~ChangeTicks() = default;
+
+	ChangeTicks(const ChangeTicks &other) = delete;
+	ChangeTicks(ChangeTicks &&other) = default;
+	ChangeTicks& operator=(const ChangeTicks &other) = delete;
+	ChangeTicks& operator=(ChangeTicks &&other) = default;
+
+	/**
+	 * Starts keeping ticks for the given component type, with room for the given number of slots.
+	 */
+	void track(uint64_t componentIndex, std::size_t slotCount);
+
+	inline bool isTracked(uint64_t componentIndex) const {
+		return tracked[componentIndex];
+	}
+
+	inline bool empty() const {
+		return tracked.none();
+	}
+
+	/**
+	 * Records a change to a component at the given tick; does nothing if the component type isn't tracked.
+	 */
+	inline void mark(uint64_t componentIndex, uint32_t slot, uint64_t tick) {
+		if (componentIndex < ticks.size() && slot < ticks[componentIndex].size()) {
+			ticks[componentIndex][slot] = tick;
+		}
+	}
+
+	/**
+	 * Records a change to every tracked component in the given bits, making room for the slot if needed.
+	 */
+	void markAll(const BitsType &components, uint32_t slot, uint64_t tick);
+
+	/**
+	 * @return the tick at which the component last changed, or 0 if its type isn't tracked.
+	 */
+	inline uint64_t get(uint64_t componentIndex, uint32_t slot) const {
+		return componentIndex < ticks.size() && slot < ticks[componentIndex].size() ? ticks[componentIndex][slot] : 0u;
+	}
+
+	/**
+	 * @return the ticks for a tracked component type, indexed by entity handle slot.
+	 */
+	inline const std::vector<uint64_t> &getTicks(uint64_t componentIndex) const {
+		return ticks[componentIndex];
+	}
+
+private:
+	BitsType tracked;
+
+	// ticks[c][s] is the tick for component index c of the entity in handle slot s; empty for untracked types
+	std::vector<std::vector<uint64_t>> ticks;
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_CHANGETICKS_HPP_ */
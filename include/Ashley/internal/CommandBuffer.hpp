@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_COMMANDBUFFER_HPP_
+#define ACPP_INTERNAL_COMMANDBUFFER_HPP_
+
+#include <vector>
+
+#include "Ashley/internal/ComponentOperations.hpp"
+
+namespace ashley {
+class Engine;
+class Entity;
+
+namespace internal {
+
+/**
+ * <p>Structural changes queued during {@link Engine#update(float)}: entities to add, component operations and
+ * entities to remove, each kept in the order they were queued.</p>
+ *
+ * <p>While a system is updating, the engine gives it a buffer of its own and makes that buffer current on whichever
+ * thread runs the system; see {@link CommandBuffer#Scope}. Changes are then queued into the current buffer without
+ * locking, and the engine applies the buffers in system priority order once every system has finished, so the result
+ * doesn't depend on how the systems were spread across threads. Tasks which split up a system's work can do the same
+ * with a buffer per task, appending them to the system's buffer in task order when they're done.</p>
+ *
+ * <p>A current buffer belongs to one engine, so a thread working for one engine never queues another engine's changes
+ * into it; this matters when systems update a second engine, or when engines share worker threads.</p>
+ *
+ * <p>Changes made while an engine is updating from a thread with no current buffer of that engine's - tasks a system
+ * hands to a thread pool itself, or threads the engine knows nothing about - go into one shared, locked buffer which
+ * is applied after every system's buffer. Changes from a single such thread keep their order, but the order between
+ * several of them follows thread timing, so systems wanting deterministic results should make their changes from the
+ * thread they were updated on, or from tasks with a buffer of their own.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class CommandBuffer {
+public:
+	/**
+	 * <p>Makes a buffer current on the calling thread for the given engine for the lifetime of the scope, restoring
+	 * whichever buffer was current before.</p>
+	 */
+	class Scope {
+	public:
+		Scope(CommandBuffer &buffer, const Engine *engine);
+		~Scope();
+
+		Scope(const Scope &other) = delete;
+		Scope(Scope &&other) = delete;
+		Scope& operator=(const Scope &other) = delete;
+		Scope& operator=(Scope &&other) = delete;
+
+	private:
+		CommandBuffer *previous;
+		const Engine *previousEngine;
+	};
+
+	CommandBuffer() = default;
+
+	/**
+	 * Releases the components of any add operations which were never applied.
+	 */
+	~CommandBuffer();
+
+	CommandBuffer(const CommandBuffer &other) = delete;
+	CommandBuffer(CommandBuffer &&other) = default;
+	CommandBuffer& operator=(const CommandBuffer &other) = delete;
+	CommandBuffer& operator=(CommandBuffer &&other) = default;
+
+	// entities to be added to the engine; these aren't owned by it yet
+	std::vector<Entity *> addedEntities;
+	std::vector<ComponentOperation> operations;
+	std::vector<Entity *> removedEntities;
+
+	/**
+	 * @return the buffer current on the calling thread for the given engine, or nullptr if there isn't one.
+	 */
+	static CommandBuffer *getCurrent(const Engine *engine);
+
+	inline bool empty() const {
+		return addedEntities.empty() && operations.empty() && removedEntities.empty();
+	}
+
+	/**
+	 * Moves everything queued in other onto the end of this buffer, leaving other empty.
+	 */
+	void append(CommandBuffer &other);
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_COMMANDBUFFER_HPP_ */
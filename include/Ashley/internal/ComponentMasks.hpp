@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_COMPONENTMASKS_HPP_
+#define ACPP_INTERNAL_COMPONENTMASKS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+
+namespace ashley {
+class Family;
+
+namespace internal {
+
+/**
+ * <p>The component bits of every {@link Entity} in an {@link Engine}, packed so that a {@link Family} can be matched
+ * against many entities at once. Masks are stored by position in the engine's entity list, with one column of 64-bit
+ * words for each 64 component indices so that neighbouring entities' words are contiguous.</p>
+ *
+ * <p>Matching uses AVX2 when the library is built with it, SSE2 on other x86 targets and scalar code elsewhere.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class ComponentMasks {
+public:
+	ComponentMasks() = default;
+	~ComponentMasks() = default;
+
+	ComponentMasks(const ComponentMasks &other) = delete;
+	ComponentMasks(ComponentMasks &&other) = default;
+	ComponentMasks& operator=(const ComponentMasks &other) = delete;
+	ComponentMasks& operator=(ComponentMasks &&other) = default;
+
+	inline std::size_t size() const {
+		return count;
+	}
+
+	/**
+	 * Reserves room for the given number of masks in every column.
+	 */
+	void reserve(std::size_t capacity);
+
+	/**
+	 * Adds a mask for a new entity at the end.
+	 */
+	void push_back(const BitsType &bits);
+
+	/**
+	 * Replaces the whole mask at the given position.
+	 */
+	void assign(std::size_t position, const BitsType &bits);
+
+	/**
+	 * Sets or clears a single component bit in the mask at the given position.
+	 */
+	void set(std::size_t position, uint64_t componentIndex, bool value);
+
+	/**
+	 * Removes the mask at the given position by moving the last mask into its place, mirroring how entities are
+	 * removed from the engine.
+	 */
+	void swapAndPop(std::size_t position);
+
+	void clear();
+
+	/**
+	 * <p>Appends the position of every mask matched by the family, in ascending order. Gives the same results as
+	 * calling {@link Family#matches} on each mask.</p>
+	 */
+	void match(const Family &family, std::vector<std::size_t> &matches) const;
+
+private:
+	std::size_t count = 0u;
+
+	// columns[w][i] holds bits 64w to 64w + 63 of the mask at position i
+	std::vector<std::vector<uint64_t>> columns;
+
+	void ensureColumns(std::size_t columnCount);
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_COMPONENTMASKS_HPP_ */
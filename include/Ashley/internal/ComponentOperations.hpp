@@ -17,10 +17,12 @@
 #ifndef ACPP_INTERNAL_COMPONENTOPERATIONS_HPP_
 #define ACPP_INTERNAL_COMPONENTOPERATIONS_HPP_
 
+#include <cstdint>
+
 #include <memory>
 
 #include "Ashley/core/Component.hpp"
-#include "Ashley/util/ObjectPools.hpp"
+#include "Ashley/core/EntityHandle.hpp"
 
 namespace ashley {
 class Entity;
@@ -35,60 +37,49 @@ public:
 	virtual ~ComponentOperationHandler() {
 	}
 
-	virtual void add(ashley::Entity * const entity, std::unique_ptr<Component> &&component,
-	        const std::type_index typeIndex) = 0;
-	virtual void remove(ashley::Entity * const entity, const std::type_index typeIndex) = 0;
+	virtual void add(ashley::Entity * const entity, ComponentPtr &&component, uint64_t componentIndex) = 0;
+	virtual void remove(ashley::Entity * const entity, uint64_t componentIndex) = 0;
+	virtual void removeAll(ashley::Entity * const entity) = 0;
 };
 
 /**
- * <p>Struct representing all the details required about a component operation.</p>
+ * <p>A deferred component operation, stored by value in a contiguous buffer and replayed in order at the end of an
+ * update. Plain data, so queueing and replaying operations never allocates once the buffer has grown.</p>
+ *
+ * <p>An ADD operation owns its component until it's replayed; use {@link ComponentOperation#takeComponent} to
+ * reclaim it.</p>
  *
  * <p>Internal class; you probably don't need this.</p>
  */
-struct ComponentOperation : public ashley::Poolable {
-	enum class Type {
-		ADD, REMOVE, NONE
+struct ComponentOperation {
+	enum class Type : uint8_t {
+		ADD, REMOVE
 	};
 
 	Type type;
+	EntityHandle entity;
+	uint64_t componentIndex;
 
-	ashley::Entity *entity = nullptr;
-	std::unique_ptr<std::type_index> typeIndex;
-	std::unique_ptr<Component> component = nullptr;
-
-	ComponentOperation() :
-			        type(Type::NONE),
-			        typeIndex { std::unique_ptr<std::type_index>(nullptr) } {
-	}
-
-	virtual ~ComponentOperation() {
-	}
-
-	// TODO: Remove use of "new" here
-
-	inline void makeAdd(ashley::Entity *entity, std::unique_ptr<Component> &&component,
-	        const std::type_index typeIndex) {
-		this->type = Type::ADD;
+	// only set for ADD operations
+	Component *component;
+	void (*release)(Component *component);
 
-		this->entity = entity;
-		this->component = std::move(component);
-		this->typeIndex = std::unique_ptr<std::type_index>(new std::type_index(typeIndex));
+	static inline ComponentOperation makeAdd(EntityHandle entity, ComponentPtr &&component,
+	        uint64_t componentIndex) {
+		const auto release = component.get_deleter().release;
+		return ComponentOperation { Type::ADD, entity, componentIndex, component.release(), release };
 	}
 
-	inline void makeRemove(ashley::Entity *entity, const std::type_index typeIndex) {
-		this->type = Type::REMOVE;
-
-		this->entity = entity;
-		this->typeIndex = std::unique_ptr<std::type_index>(new std::type_index(typeIndex));
+	static inline ComponentOperation makeRemove(EntityHandle entity, uint64_t componentIndex) {
+		return ComponentOperation { Type::REMOVE, entity, componentIndex, nullptr, nullptr };
 	}
 
-	void reset() override {
-		entity = nullptr;
+	inline ComponentPtr takeComponent() {
+		ComponentPtr ret(component, ComponentDeleter(release));
 		component = nullptr;
-		this->type = Type::NONE;
+		return ret;
 	}
 };
-
 }
 
-#endif /* COMPONENTOPERATIONS_HPP_ */
+#endif /* ACPP_INTERNAL_COMPONENTOPERATIONS_HPP_ */
@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_COMPONENTPOOL_HPP_
+#define ACPP_INTERNAL_COMPONENTPOOL_HPP_
+
+#include <cassert>
+#include <cstddef>
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Component.hpp"
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/util/ObjectPools.hpp"
+
+namespace ashley {
+namespace internal {
+
+/**
+ * <p>Allocates the individually stored {@link Component}s of one type from blocks of memory shared by every
+ * {@link Entity}, so that adding and removing components recycles memory rather than going to the heap each time and
+ * components of the same type are kept close together.</p>
+ *
+ * <p>Components which also derive from {@link Poolable} are reset rather than destroyed when they're removed, and are
+ * reused as they are when a component of their type is next added with no constructor arguments.</p>
+ *
+ * <p>Pools are shared between threads and never release their memory.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+template<typename C> class ComponentPool {
+public:
+	/**
+	 * @return a new component constructed from the given arguments, which is returned to the pool when deleted.
+	 */
+	template<typename ...Args> static ComponentPtr make(Args &&...args) {
+		return get().construct(IsPoolable(), std::forward<Args>(args)...);
+	}
+
+	/**
+	 * The deleter for components made by this pool.
+	 */
+	static void release(Component *component) {
+		get().recycle(IsPoolable(), static_cast<C *>(component));
+	}
+
+	ComponentPool(const ComponentPool &other) = delete;
+	ComponentPool(ComponentPool &&other) = delete;
+	ComponentPool& operator=(const ComponentPool &other) = delete;
+	ComponentPool& operator=(ComponentPool &&other) = delete;
+
+private:
+	using IsPoolable = std::is_base_of<Poolable, C>;
+
+	static const std::size_t objectsPerBlock =
+	        sizeof(C) < ASHLEY_COMPONENT_BLOCK_SIZE ? ASHLEY_COMPONENT_BLOCK_SIZE / sizeof(C) : 1u;
+
+	std::mutex mutex;
+
+	std::vector<std::unique_ptr<unsigned char[]>> blocks;
+
+	// unconstructed memory for one component each
+	std::vector<void *> freeMemory;
+
+	// components which were reset instead of destroyed; only used for Poolable components
+	std::vector<C *> resetComponents;
+
+	ComponentPool() = default;
+
+	static ComponentPool &get() {
+		// never destroyed, so components can safely be released during static destruction
+		static ComponentPool * const pool = new ComponentPool();
+		return *pool;
+	}
+
+	ComponentPtr construct(std::true_type) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (!resetComponents.empty()) {
+				auto component = resetComponents.back();
+				resetComponents.pop_back();
+				return ComponentPtr(component, ComponentDeleter(&release));
+			}
+		}
+
+		return construct(std::false_type());
+	}
+
+	template<typename ...Args> ComponentPtr construct(std::true_type, Args &&...args) {
+		return construct(std::false_type(), std::forward<Args>(args)...);
+	}
+
+	template<typename ...Args> ComponentPtr construct(std::false_type, Args &&...args) {
+		void *memory = allocate();
+		return ComponentPtr(new (memory) C(std::forward<Args>(args)...), ComponentDeleter(&release));
+	}
+
+	void recycle(std::true_type, C *component) {
+		component->reset();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		resetComponents.push_back(component);
+	}
+
+	void recycle(std::false_type, C *component) {
+		component->~C();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		freeMemory.push_back(component);
+	}
+
+	void *allocate() {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (freeMemory.empty()) {
+			// constructing with arguments can't reuse a reset component as it is, but can reuse its memory
+			if (!resetComponents.empty()) {
+				auto component = resetComponents.back();
+				resetComponents.pop_back();
+				component->~C();
+
+				return component;
+			}
+
+			allocateBlock();
+		}
+
+		auto memory = freeMemory.back();
+		freeMemory.pop_back();
+		return memory;
+	}
+
+	void allocateBlock() {
+		std::size_t space = objectsPerBlock * sizeof(C) + alignof(C);
+		blocks.emplace_back(new unsigned char[space]);
+
+		void *start = blocks.back().get();
+		std::align(alignof(C), objectsPerBlock * sizeof(C), start, space);
+
+		// pushed in reverse so that components are handed out in address order
+		for (auto i = objectsPerBlock; i > 0u; i--) {
+			freeMemory.push_back(static_cast<unsigned char *>(start) + (i - 1) * sizeof(C));
+		}
+	}
+};
+
+template<typename C, typename ...Args> ComponentPtr makeComponentImpl(std::true_type, Args &&...args) {
+	return ComponentPool<C>::make(std::forward<Args>(args)...);
+}
+
+template<typename C, typename ...Args> ComponentPtr makeComponentImpl(std::false_type, Args &&...args) {
+	return ComponentPtr(new C(std::forward<Args>(args)...),
+	        ComponentDeleter(ComponentType::getFor<C>().getOperations().deleteHeap));
+}
+
+/**
+ * <p>Makes a component for individual storage, from its type's {@link ComponentPool} where possible.</p>
+ *
+ * <p>Types which can't be moved are allocated with new instead, so that {@link releaseToHeap} can always hand back a
+ * removed component as a std::unique_ptr.</p>
+ */
+template<typename C, typename ...Args> ComponentPtr makeComponent(Args &&...args) {
+	return makeComponentImpl<C>(std::is_move_constructible<C>(), std::forward<Args>(args)...);
+}
+
+/**
+ * <p>Converts a component allocated by the library into a std::unique_ptr, moving it into a new heap allocation if it
+ * wasn't allocated with new.</p>
+ */
+template<typename C> std::unique_ptr<C> releaseToHeap(ComponentPtr &&component) {
+	if (component == nullptr) {
+		return std::unique_ptr<C>(nullptr);
+	}
+
+	const auto &operations = ComponentType::getFor<C>().getOperations();
+
+	if (component.get_deleter().release == operations.deleteHeap) {
+		return std::unique_ptr<C>(static_cast<C *>(component.release()));
+	}
+
+	assert(operations.moveToHeap != nullptr && "only movable components are allocated outside the heap");
+	return std::unique_ptr<C>(static_cast<C *>(operations.moveToHeap(component.get())));
+}
+
+}
+}
+
+#endif /* ACPP_INTERNAL_COMPONENTPOOL_HPP_ */
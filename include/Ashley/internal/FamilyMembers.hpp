@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_FAMILYMEMBERS_HPP_
+#define ACPP_INTERNAL_FAMILYMEMBERS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ashley {
+class Entity;
+class Family;
+
+namespace internal {
+
+/**
+ * <p>The entities in an {@link Engine} which belong to one {@link Family}, stored as a sparse set keyed by the slot
+ * index of each entity's {@link EntityHandle}. Membership tests, additions and removals are constant time and the
+ * members are kept in a dense vector for iteration.</p>
+ *
+ * <p>The sparse side is split into pages which are only allocated once a member falls into them, so a family
+ * matching few entities costs little memory however many entities the engine has.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class FamilyMembers {
+public:
+	/**
+	 * @param family the family whose members are stored.
+	 * @param id the family's dense index within its engine.
+	 */
+	FamilyMembers(const Family &family, std::size_t id);
+	~FamilyMembers() = default;
+
+	FamilyMembers(const FamilyMembers &other) = delete;
+	FamilyMembers(FamilyMembers &&other) = delete;
+	FamilyMembers& operator=(const FamilyMembers &other) = delete;
+	FamilyMembers& operator=(FamilyMembers &&other) = delete;
+
+	inline const Family &getFamily() const {
+		return family;
+	}
+
+	inline std::size_t getId() const {
+		return id;
+	}
+
+	inline std::vector<Entity *> &getEntities() {
+		return entities;
+	}
+
+	inline bool contains(uint32_t slot) const {
+		const auto page = slot >> pageShift;
+		return page < pages.size() && pages[page] != nullptr && pages[page][slot & pageMask] != 0u;
+	}
+
+	/**
+	 * @return the member with the given slot, or nullptr if there's no such member.
+	 */
+	inline Entity *find(uint32_t slot) const {
+		const auto page = slot >> pageShift;
+
+		if (page >= pages.size() || pages[page] == nullptr) {
+			return nullptr;
+		}
+
+		const auto position = pages[page][slot & pageMask];
+		return position == 0u ? nullptr : entities[position - 1];
+	}
+
+	/**
+	 * Adds an entity which isn't already a member, keyed by its handle's slot.
+	 */
+	void add(Entity &entity, uint32_t slot);
+
+	/**
+	 * Removes the member with the given slot by moving the last member into its place.
+	 */
+	void remove(uint32_t slot);
+
+	/**
+	 * Removes every member.
+	 */
+	void clear();
+
+private:
+	static const uint32_t pageShift = 12u;
+	static const uint32_t pageMask = (1u << pageShift) - 1;
+
+	const Family &family;
+	std::size_t id;
+
+	std::vector<Entity *> entities;
+
+	// each entry holds one past the member's position in entities, or 0 for entities which aren't members
+	std::vector<std::unique_ptr<uint32_t[]>> pages;
+
+	uint32_t &getPosition(uint32_t slot);
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_FAMILYMEMBERS_HPP_ */
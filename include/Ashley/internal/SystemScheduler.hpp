@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_INTERNAL_SYSTEMSCHEDULER_HPP_
+#define ACPP_INTERNAL_SYSTEMSCHEDULER_HPP_
+
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace ashley {
+class EntitySystem;
+class ThreadPool;
+
+namespace internal {
+class CommandBuffer;
+
+/**
+ * <p>Updates an {@link Engine}'s systems on a {@link ThreadPool}. Each system waits for every system before it in
+ * priority order which it conflicts with, and systems which don't conflict run at the same time; see
+ * {@link EntitySystem#conflictsWith}.</p>
+ *
+ * <p>Internal class; you probably don't need this.</p>
+ */
+class SystemScheduler {
+public:
+	explicit SystemScheduler(ThreadPool &threadPool);
+	~SystemScheduler() = default;
+
+	SystemScheduler(const SystemScheduler &other) = delete;
+	SystemScheduler(SystemScheduler &&other) = delete;
+	SystemScheduler& operator=(const SystemScheduler &other) = delete;
+	SystemScheduler& operator=(SystemScheduler &&other) = delete;
+
+	/**
+	 * Updates every processing system, returning once all of them have finished. The systems must be sorted by
+	 * priority, and each system's structural changes are queued into the command buffer at the same position.
+	 */
+	void update(const std::vector<std::unique_ptr<EntitySystem>> &systems, std::vector<CommandBuffer> &buffers,
+	        float deltaTime);
+
+private:
+	struct Node {
+		EntitySystem *system;
+		std::size_t predecessorCount;
+		std::vector<std::size_t> successors;
+	};
+
+	ThreadPool &threadPool;
+
+	// rebuilt every update since priorities and declared access can change at any time; storage is reused
+	std::vector<Node> nodes;
+
+	// per node count of predecessors which haven't finished yet in the current update
+	std::unique_ptr<std::atomic<std::size_t>[]> pending;
+	std::size_t pendingCapacity;
+
+	std::atomic<std::size_t> remaining;
+	CommandBuffer *buffers;
+	float deltaTime;
+
+	void buildGraph(const std::vector<std::unique_ptr<EntitySystem>> &systems);
+
+	void runNode(std::size_t index);
+};
+
+}
+}
+
+#endif /* ACPP_INTERNAL_SYSTEMSCHEDULER_HPP_ */
@@ -64,7 +64,6 @@ protected:
 
 	virtual void processEntity(Entity * const entity) = 0;
 
-private:
 	Family *family = nullptr;
 	std::vector<Entity *> *entities = nullptr;
 };
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_SYSTEMS_PARALLELITERATINGSYSTEM_HPP_
+#define ACPP_SYSTEMS_PARALLELITERATINGSYSTEM_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/internal/CommandBuffer.hpp"
+#include "Ashley/systems/IteratingSystem.hpp"
+
+namespace ashley {
+
+class Family;
+
+/**
+ * <p>An {@link IteratingSystem} which splits its entities into chunks and processes the chunks at the same time on
+ * the {@link Engine}'s {@link ThreadPool}. Without worker threads, or outside of {@link Engine#update(float)}, it
+ * behaves exactly like an IteratingSystem.</p>
+ *
+ * <p>processEntity() can be called from several threads at once and must only change the entity it's given. Adding
+ * or removing components and adding or removing entities is safe since these operations are deferred until the end
+ * of the update, but the types of any components added must already have been registered with
+ * {@link ComponentType}. Each chunk queues its changes separately and they're applied in chunk order, so the result
+ * is the same as processing the entities one after another.</p>
+ *
+ * @author Ashley Davis (SgtCoDFish)
+ */
+class ParallelIteratingSystem : public ashley::IteratingSystem {
+public:
+	/**
+	 * @param family The family of entities iterated over in this System
+	 * @param priority The priority to execute this system with (lower means higher priority)
+	 * @param chunkSize The number of entities processed by each task
+	 */
+	ParallelIteratingSystem(Family *family, int64_t priority, std::size_t chunkSize = ASHLEY_PARALLEL_CHUNK_SIZE) :
+			IteratingSystem(family, priority),
+			chunkSize(chunkSize) {
+	}
+
+	virtual ~ParallelIteratingSystem() = default;
+
+	ParallelIteratingSystem(const ParallelIteratingSystem &other) :
+			IteratingSystem(other),
+			chunkSize(other.chunkSize) {
+	}
+
+	ParallelIteratingSystem(ParallelIteratingSystem &&other) = default;
+
+	ParallelIteratingSystem &operator=(const ParallelIteratingSystem &other) {
+		IteratingSystem::operator=(other);
+		chunkSize = other.chunkSize;
+		return *this;
+	}
+
+	ParallelIteratingSystem &operator=(ParallelIteratingSystem &&other) = default;
+
+	virtual void update(float deltaTime) override;
+
+	std::size_t getChunkSize() const {
+		return chunkSize;
+	}
+
+	void setChunkSize(std::size_t chunkSize) {
+		this->chunkSize = chunkSize;
+	}
+
+private:
+	std::size_t chunkSize;
+
+	// one per chunk in the current update; kept to reuse their storage
+	std::vector<internal::CommandBuffer> chunkBuffers;
+};
+}
+
+#endif
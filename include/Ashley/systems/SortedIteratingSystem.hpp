@@ -64,6 +64,16 @@ public:
 	virtual void entityAdded(ashley::Entity &entity) override;
 	virtual void entityRemoved(ashley::Entity &entity) override;
 
+	/**
+	 * <p>Appends every entity and sorts once, when next updated.</p>
+	 */
+	virtual void entitiesAdded(const std::vector<ashley::Entity *> &entities) override;
+
+	/**
+	 * <p>Removes every entity in a single pass over the sorted entities, keeping their order.</p>
+	 */
+	virtual void entitiesRemoved(const std::vector<ashley::Entity *> &entities) override;
+
 	virtual void update(float deltaTime) override;
 
 protected:
@@ -73,7 +83,9 @@ protected:
 
 	bool shouldSort { false };
 
-private:
+	// the entities being removed by entitiesRemoved, sorted by address; kept to reuse its memory
+	std::vector<Entity *> removing;
+
 	void sort();
 };
 
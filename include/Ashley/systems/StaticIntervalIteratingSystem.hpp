@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_SYSTEMS_STATICINTERVALITERATINGSYSTEM_HPP_
+#define ACPP_SYSTEMS_STATICINTERVALITERATINGSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/systems/IntervalIteratingSystem.hpp"
+
+namespace ashley {
+class Entity;
+class Family;
+
+/**
+ * <p>An {@link IntervalIteratingSystem} which calls <em>Derived</em>'s processEntity directly rather than through
+ * the vtable. See {@link StaticIteratingSystem}.</p>
+ *
+ * <p>The base class can only call <em>Derived</em>'s processEntity directly if it's public.</p>
+ */
+template<typename Derived> class StaticIntervalIteratingSystem : public ashley::IntervalIteratingSystem {
+public:
+	StaticIntervalIteratingSystem(Family *family, float interval, int64_t priority) :
+			IntervalIteratingSystem(family, interval, priority) {
+	}
+
+	virtual ~StaticIntervalIteratingSystem() = default;
+	StaticIntervalIteratingSystem(const StaticIntervalIteratingSystem &other) = default;
+	StaticIntervalIteratingSystem(StaticIntervalIteratingSystem &&other) = default;
+	StaticIntervalIteratingSystem& operator=(const StaticIntervalIteratingSystem &other) = default;
+	StaticIntervalIteratingSystem& operator=(StaticIntervalIteratingSystem &&other) = default;
+
+protected:
+	virtual void updateInterval() override {
+		auto &derived = static_cast<Derived &>(*this);
+
+		for (auto entity : *entities) {
+			derived.Derived::processEntity(entity);
+		}
+	}
+};
+}
+
+#endif /* ACPP_SYSTEMS_STATICINTERVALITERATINGSYSTEM_HPP_ */
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_SYSTEMS_STATICITERATINGSYSTEM_HPP_
+#define ACPP_SYSTEMS_STATICITERATINGSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/systems/IteratingSystem.hpp"
+
+namespace ashley {
+class Entity;
+class Family;
+
+/**
+ * <p>An {@link IteratingSystem} which calls <em>Derived</em>'s processEntity directly rather than through the
+ * vtable, so that a small per-entity body can be inlined into the loop over the family's entities.</p>
+ *
+ * <p>Derive as <code>class MySystem final : public StaticIteratingSystem&lt;MySystem&gt;</code> and override
+ * processEntity; the system is scheduled exactly like any other {@link EntitySystem}.</p>
+ *
+ * <p>The base class can only call <em>Derived</em>'s processEntity directly if it's public.</p>
+ */
+template<typename Derived> class StaticIteratingSystem : public ashley::IteratingSystem {
+public:
+	StaticIteratingSystem(Family *family, int64_t priority) :
+			IteratingSystem(family, priority) {
+	}
+
+	virtual ~StaticIteratingSystem() = default;
+	StaticIteratingSystem(const StaticIteratingSystem &other) = default;
+	StaticIteratingSystem(StaticIteratingSystem &&other) = default;
+	StaticIteratingSystem& operator=(const StaticIteratingSystem &other) = default;
+	StaticIteratingSystem& operator=(StaticIteratingSystem &&other) = default;
+
+	virtual void update(float deltaTime) override {
+		auto &derived = static_cast<Derived &>(*this);
+
+		for (auto entity : *entities) {
+			derived.Derived::processEntity(entity, deltaTime);
+		}
+	}
+};
+}
+
+#endif /* ACPP_SYSTEMS_STATICITERATINGSYSTEM_HPP_ */
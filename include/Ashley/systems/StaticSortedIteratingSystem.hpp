@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_SYSTEMS_STATICSORTEDITERATINGSYSTEM_HPP_
+#define ACPP_SYSTEMS_STATICSORTEDITERATINGSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/systems/SortedIteratingSystem.hpp"
+
+namespace ashley {
+class Entity;
+class Family;
+
+/**
+ * <p>A {@link SortedIteratingSystem} which calls <em>Derived</em>'s processEntity directly rather than through the
+ * vtable. See {@link StaticIteratingSystem}.</p>
+ *
+ * <p>The base class can only call <em>Derived</em>'s processEntity directly if it's public.</p>
+ */
+template<typename Derived> class StaticSortedIteratingSystem : public ashley::SortedIteratingSystem {
+public:
+	StaticSortedIteratingSystem(Family *family, Comparator comparator, int64_t priority) :
+			SortedIteratingSystem(family, comparator, priority) {
+	}
+
+	virtual ~StaticSortedIteratingSystem() = default;
+	StaticSortedIteratingSystem(const StaticSortedIteratingSystem &other) = default;
+	StaticSortedIteratingSystem(StaticSortedIteratingSystem &&other) = default;
+	StaticSortedIteratingSystem& operator=(const StaticSortedIteratingSystem &other) = default;
+	StaticSortedIteratingSystem& operator=(StaticSortedIteratingSystem &&other) = default;
+
+	virtual void update(float deltaTime) override {
+		sort();
+
+		auto &derived = static_cast<Derived &>(*this);
+
+		for (auto entity : sortedEntities) {
+			derived.Derived::processEntity(entity, deltaTime);
+		}
+	}
+};
+}
+
+#endif /* ACPP_SYSTEMS_STATICSORTEDITERATINGSYSTEM_HPP_ */
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_UTIL_BITS_HPP_
+#define ACPP_UTIL_BITS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <functional>
+
+// Number of 64 bit words stored inside a Bits object before it switches to a heap allocation.
+#ifndef ASHLEY_BITS_INLINE_WORDS
+#define ASHLEY_BITS_INLINE_WORDS 2
+#endif
+
+namespace ashley {
+
+/**
+ * <p>A growable set of bits, similar to the Bits class used by the Java original.</p>
+ *
+ * <p>Bits grow as needed when bits are set, so there's no fixed limit to the number of {@link Component} types or
+ * {@link Family}s. Every bit beyond the current size is treated as 0, and two Bits are equal if they have the same
+ * bits set, regardless of their size. The first ASHLEY_BITS_INLINE_WORDS words are stored inside the object so that
+ * masks of small indices never allocate.</p>
+ *
+ * <p>Operations work a whole 64 bit word at a time in simple loops which compilers can vectorise.</p>
+ */
+class Bits {
+public:
+	/** Returned by {@link #nextSetBit} when there are no more set bits. */
+	static const std::size_t npos;
+
+	Bits() :
+			        wordCount(inlineWordCount) {
+		std::memset(inlineWords, 0, sizeof(inlineWords));
+	}
+
+	~Bits() {
+		if (isHeap()) {
+			delete[] heapWords;
+		}
+	}
+
+	Bits(const Bits &other) :
+			        wordCount(inlineWordCount) {
+		std::memset(inlineWords, 0, sizeof(inlineWords));
+		copyFrom(other);
+	}
+
+	Bits(Bits &&other) :
+			        wordCount(other.wordCount) {
+		std::memcpy(inlineWords, other.inlineWords, sizeof(inlineWords));
+
+		other.wordCount = inlineWordCount;
+		std::memset(other.inlineWords, 0, sizeof(other.inlineWords));
+	}
+
+	Bits &operator=(const Bits &other) {
+		if (this != &other) {
+			copyFrom(other);
+		}
+
+		return *this;
+	}
+
+	Bits &operator=(Bits &&other) {
+		if (this != &other) {
+			if (isHeap()) {
+				delete[] heapWords;
+			}
+
+			wordCount = other.wordCount;
+			std::memcpy(inlineWords, other.inlineWords, sizeof(inlineWords));
+
+			other.wordCount = inlineWordCount;
+			std::memset(other.inlineWords, 0, sizeof(other.inlineWords));
+		}
+
+		return *this;
+	}
+
+	/**
+	 * @return the number of bits currently stored. Every bit at or beyond this index is 0.
+	 */
+	inline std::size_t size() const {
+		return wordCount * bitsPerWord;
+	}
+
+	inline std::size_t getWordCount() const {
+		return wordCount;
+	}
+
+	inline const uint64_t *getWords() const {
+		return isHeap() ? heapWords : inlineWords;
+	}
+
+	inline bool test(std::size_t index) const {
+		const auto word = index / bitsPerWord;
+		return word < wordCount && ((getWords()[word] >> (index % bitsPerWord)) & 1u) != 0u;
+	}
+
+	inline bool operator[](std::size_t index) const {
+		return test(index);
+	}
+
+	/**
+	 * <p>Sets or clears a bit, growing the storage if needed to set it.</p>
+	 */
+	inline Bits &set(std::size_t index, bool value = true) {
+		const auto word = index / bitsPerWord;
+		const auto mask = uint64_t(1) << (index % bitsPerWord);
+
+		if (value) {
+			if (word >= wordCount) {
+				grow(word + 1);
+			}
+
+			getWords()[word] |= mask;
+		} else if (word < wordCount) {
+			getWords()[word] &= ~mask;
+		}
+
+		return *this;
+	}
+
+	inline Bits &reset(std::size_t index) {
+		return set(index, false);
+	}
+
+	/**
+	 * <p>Clears every bit without releasing any storage.</p>
+	 */
+	inline Bits &reset() {
+		std::memset(getWords(), 0, wordCount * sizeof(uint64_t));
+		return *this;
+	}
+
+	bool any() const;
+
+	inline bool none() const {
+		return !any();
+	}
+
+	/**
+	 * @return the number of set bits.
+	 */
+	std::size_t count() const;
+
+	/**
+	 * @return the number of set bits with an index lower than the given index.
+	 */
+	std::size_t countBelow(std::size_t index) const;
+
+	/**
+	 * @return the index of the first set bit at or after from, or {@link #npos} if there isn't one.
+	 */
+	std::size_t nextSetBit(std::size_t from) const;
+
+	/**
+	 * @return true if every bit set in other is also set in this.
+	 */
+	bool containsAll(const Bits &other) const;
+
+	/**
+	 * @return true if any bit is set in both this and other.
+	 */
+	bool intersects(const Bits &other) const;
+
+	Bits &operator&=(const Bits &other);
+	Bits &operator|=(const Bits &other);
+
+	/**
+	 * <p>Clears every bit which is set in other.</p>
+	 */
+	Bits &andNot(const Bits &other);
+
+	friend Bits operator&(Bits lhs, const Bits &rhs) {
+		return lhs &= rhs;
+	}
+
+	friend Bits operator|(Bits lhs, const Bits &rhs) {
+		return lhs |= rhs;
+	}
+
+	bool operator==(const Bits &other) const;
+
+	inline bool operator!=(const Bits &other) const {
+		return !(*this == other);
+	}
+
+	/**
+	 * @return a hash of the set bits, which ignores trailing words with no bits set.
+	 */
+	std::size_t hash() const;
+
+	static std::size_t popCount(uint64_t word);
+
+	static std::size_t countTrailingZeros(uint64_t word);
+
+private:
+	static constexpr std::size_t bitsPerWord = 64u;
+	static constexpr uint32_t inlineWordCount = ASHLEY_BITS_INLINE_WORDS;
+
+	union {
+		uint64_t inlineWords[inlineWordCount];
+		uint64_t *heapWords;
+	};
+
+	uint32_t wordCount;
+
+	inline bool isHeap() const {
+		return wordCount > inlineWordCount;
+	}
+
+	inline uint64_t *getWords() {
+		return isHeap() ? heapWords : inlineWords;
+	}
+
+	void grow(std::size_t words);
+
+	void copyFrom(const Bits &other);
+};
+
+}
+
+namespace std {
+template<> struct hash<ashley::Bits> {
+	std::size_t operator()(const ashley::Bits &bits) const {
+		return bits.hash();
+	}
+};
+}
+
+#endif /* ACPP_UTIL_BITS_HPP_ */
@@ -18,9 +18,12 @@
 #define ACPP_UTIL_OBJECTPOOLS_HPP_
 
 #include <cassert>
+#include <cstddef>
 
+#include <memory>
 #include <stack>
 #include <utility>
+#include <vector>
 
 namespace ashley {
 
@@ -111,6 +114,75 @@ public:
 	}
 };
 
+/**
+ * <p>An object pool which allocates objects in blocks rather than one at a time, and recycles freed objects through a
+ * free list. Once enough objects have been allocated, obtaining and freeing objects never touches the heap.</p>
+ *
+ * <p>Unlike {@link ObjectPool}, every object belongs to the pool and is destroyed along with it; objects must be
+ * returned with free rather than deleted.</p>
+ */
+template<typename T> class SlabPool {
+public:
+	explicit SlabPool(std::size_t blockSize) :
+			        blockSize(blockSize) {
+		assert(blockSize >= 1u && "blockSize must be >= 1");
+	}
+
+	~SlabPool() = default;
+
+	SlabPool(const SlabPool &other) = delete;
+	SlabPool(SlabPool &&other) = default;
+	SlabPool& operator=(const SlabPool &other) = delete;
+	SlabPool& operator=(SlabPool &&other) = default;
+
+	/**
+	 * <p>Returns a free object, allocating a new block of objects first if there are none.</p>
+	 * @return a pointer to an object owned by the pool, will not be nullptr.
+	 */
+	T *obtain() {
+		if (freeObjects.empty()) {
+			allocateBlock();
+		}
+
+		T *obj = freeObjects.back();
+		freeObjects.pop_back();
+		return obj;
+	}
+
+	/**
+	 * <p>Resets the object and makes it available to be obtained again.</p>
+	 * @param object an object obtained from this pool. Don't use it after passing it to this function.
+	 */
+	void free(T *object) {
+		object->reset();
+
+		freeObjects.push_back(object);
+	}
+
+	/**
+	 * @return the number of objects allocated by this pool, whether in use or free.
+	 */
+	inline std::size_t getCapacity() const {
+		return blocks.size() * blockSize;
+	}
+
+private:
+	std::size_t blockSize;
+
+	std::vector<std::unique_ptr<T[]>> blocks;
+	std::vector<T *> freeObjects;
+
+	void allocateBlock() {
+		blocks.emplace_back(new T[blockSize]);
+		freeObjects.reserve(getCapacity());
+
+		// pushed in reverse so that objects are handed out in address order
+		for (auto i = blockSize; i > 0u; i--) {
+			freeObjects.push_back(&blocks.back()[i - 1]);
+		}
+	}
+};
+
 }
 
 #endif /* OBJECTPOOLS_HPP_ */
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef ACPP_UTIL_THREADPOOL_HPP_
+#define ACPP_UTIL_THREADPOOL_HPP_
+
+#include <cstddef>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ashley {
+
+/**
+ * <p>A fixed-size pool of worker threads with work stealing. Each worker has its own queue of tasks; a worker takes
+ * the most recently submitted task from its own queue and, when that runs dry, steals the oldest task from another
+ * queue.</p>
+ *
+ * <p>Tasks submitted from a worker go to that worker's queue, and tasks submitted from any other thread go to a
+ * shared queue. Threads waiting on the pool via {@link #waitFor} run queued tasks themselves, so a pool with no
+ * workers still completes all of its work on the waiting thread, and only sleep once there's nothing left to take.</p>
+ */
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+	/**
+	 * @param threadCount the number of worker threads to start, in addition to any thread which waits on the pool.
+	 */
+	explicit ThreadPool(std::size_t threadCount);
+
+	/**
+	 * <p>Stops and joins all worker threads. Tasks which haven't started are discarded.</p>
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &other) = delete;
+	ThreadPool(ThreadPool &&other) = delete;
+	ThreadPool& operator=(const ThreadPool &other) = delete;
+	ThreadPool& operator=(ThreadPool &&other) = delete;
+
+	/**
+	 * @return the number of worker threads owned by this pool.
+	 */
+	inline std::size_t getThreadCount() const {
+		return threads.size();
+	}
+
+	/**
+	 * <p>Queues a task to be run by any thread in the pool.</p>
+	 */
+	void submit(Task &&task);
+
+	/**
+	 * <p>Runs queued tasks on the calling thread until the given counter reaches 0. The submitted tasks are
+	 * responsible for decrementing the counter as they complete. While there are no tasks to take, the calling thread
+	 * sleeps until a task finishes or another is submitted, so the counter must only be decremented by tasks run by
+	 * this pool.</p>
+	 */
+	void waitFor(const std::atomic<std::size_t> &remaining);
+
+	/**
+	 * <p>Splits [0, count) into consecutive ranges of at most chunkSize and calls body(begin, end) once for each range,
+	 * spreading the ranges over the calling thread and the workers. Returns once every range has been processed.</p>
+	 */
+	void parallelFor(std::size_t count, std::size_t chunkSize,
+	        const std::function<void(std::size_t begin, std::size_t end)> &body);
+
+	/**
+	 * @return a sensible default worker count for this machine, leaving one hardware thread for the caller.
+	 */
+	static std::size_t getDefaultThreadCount();
+
+private:
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	// one queue per worker, followed by the queue shared by all other threads
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> threads;
+
+	std::atomic<std::size_t> queuedCount;
+	std::atomic<bool> running;
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	// notified whenever a task finishes or is submitted, for threads in waitFor with nothing to run
+	std::condition_variable taskFinished;
+
+	/**
+	 * @return the index of the queue owned by the calling thread.
+	 */
+	std::size_t getQueueIndex() const;
+
+	/**
+	 * Runs a single task, preferring the given queue and stealing from the others.
+	 * @return true if a task was run.
+	 */
+	bool runTask(std::size_t queueIndex);
+
+	void workerLoop(std::size_t queueIndex);
+};
+
+}
+
+#endif /* ACPP_UTIL_THREADPOOL_HPP_ */
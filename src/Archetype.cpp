@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+#include <memory>
+
+#include "Ashley/core/Archetype.hpp"
+#include "Ashley/core/ComponentType.hpp"
+
+namespace {
+inline std::size_t alignUp(std::size_t offset, std::size_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
+}
+
+ashley::Archetype::Archetype(const BitsType &bits, std::size_t chunkBytes) :
+		        bits(bits),
+		        chunkShift(0u),
+		        chunkMask(0u),
+		        chunkAllocationSize(0u),
+		        count(0u) {
+	std::size_t rowSize = sizeof(Entity *);
+	std::size_t padding = 0u;
+
+	for (auto i = bits.nextSetBit(0); i != BitsType::npos; i = bits.nextSetBit(i + 1)) {
+		const auto type = ashley::ComponentType::getByIndex(i);
+		assert(type != nullptr && type->hasOperations() && "component type has never been added to an entity");
+
+		const auto &operations = type->getOperations();
+		assert(operations.moveConstruct != nullptr && "archetype storage requires move constructible components");
+		assert(operations.alignment <= alignof(std::max_align_t) && "over-aligned components are not supported");
+
+		columnLookup.resize(i + 1, -1);
+		columnLookup[i] = static_cast<int32_t>(columns.size());
+		columns.push_back(Column { i, 0u, operations });
+
+		rowSize += operations.size;
+		padding += operations.alignment;
+	}
+
+	// A power of two capacity lets rows be mapped to chunks with a shift and a mask. Chunks are only allocated as
+	// large as they need to be, so this doesn't waste memory.
+	const std::size_t usable = chunkBytes > padding ? chunkBytes - padding : 0u;
+
+	while ((std::size_t(2) << chunkShift) * rowSize <= usable) {
+		++chunkShift;
+	}
+
+	chunkMask = (std::size_t(1) << chunkShift) - 1;
+
+	std::size_t offset = getChunkCapacity() * sizeof(Entity *);
+
+	for (auto &column : columns) {
+		offset = alignUp(offset, column.operations.alignment);
+		column.offset = offset;
+		offset += getChunkCapacity() * column.operations.size;
+	}
+
+	chunkAllocationSize = offset;
+}
+
+ashley::Archetype::~Archetype() {
+	for (std::size_t row = 0u; row < count; ++row) {
+		for (auto &column : columns) {
+			column.operations.destroy(getSlot(row, column));
+		}
+	}
+}
+
+const ashley::Archetype::Column *ashley::Archetype::getColumn(uint64_t typeIndex) const {
+	if (typeIndex >= columnLookup.size() || columnLookup[typeIndex] < 0) {
+		return nullptr;
+	}
+
+	return &columns[columnLookup[typeIndex]];
+}
+
+std::size_t ashley::Archetype::push(Entity *entity) {
+	if (count == (chunks.size() << chunkShift)) {
+		chunks.emplace_back(new unsigned char[chunkAllocationSize]);
+	}
+
+	const auto row = count++;
+	getEntitySlot(row) = entity;
+
+	return row;
+}
+
+ashley::Entity *ashley::Archetype::erase(std::size_t row) {
+	assert(row < count && "invalid archetype row");
+
+	const auto last = count - 1;
+	Entity *moved = nullptr;
+
+	for (auto &column : columns) {
+		auto slot = getSlot(row, column);
+		column.operations.destroy(slot);
+
+		if (row != last) {
+			auto lastSlot = getSlot(last, column);
+			column.operations.moveConstruct(slot, lastSlot);
+			column.operations.destroy(lastSlot);
+		}
+	}
+
+	if (row != last) {
+		moved = getEntitySlot(last);
+		getEntitySlot(row) = moved;
+	}
+
+	--count;
+
+	// keep one spare chunk around so that an entity moving back and forth over a boundary doesn't thrash
+	while (chunks.size() > getChunkCount() + 1) {
+		chunks.pop_back();
+	}
+
+	return moved;
+}
@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Ashley/internal/ArchetypeStorage.hpp"
+#include "Ashley/core/Archetype.hpp"
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/Entity.hpp"
+
+ashley::internal::ArchetypeStorage::ArchetypeStorage(std::size_t chunkBytes) :
+		        chunkBytes(chunkBytes) {
+}
+
+ashley::Archetype *ashley::internal::ArchetypeStorage::getArchetype(const BitsType &bits) {
+	auto it = archetypes.find(bits);
+
+	if (it == archetypes.end()) {
+		it = archetypes.emplace(bits, std::unique_ptr<Archetype>(new Archetype(bits, chunkBytes))).first;
+		archetypeList.push_back(it->second.get());
+	}
+
+	return it->second.get();
+}
+
+void ashley::internal::ArchetypeStorage::insert(Entity &entity) {
+	auto archetype = getArchetype(entity.componentBits);
+	const auto row = archetype->push(&entity);
+
+	// components are ordered by index, so walking the bits in order visits them in turn
+	auto component = entity.components.begin();
+
+	for (auto i = entity.componentBits.nextSetBit(0); i != BitsType::npos; i = entity.componentBits.nextSetBit(i + 1)) {
+		const auto &column = archetype->columns[archetype->columnLookup[i]];
+
+		column.operations.moveConstruct(archetype->getSlot(row, column), component->get());
+		component->reset();
+		++component;
+	}
+
+	entity.components.clear();
+
+	entity.storage = this;
+	entity.archetype = archetype;
+	entity.archetypeRow = row;
+}
+
+void ashley::internal::ArchetypeStorage::insertCopy(Entity &entity, const BitsType &bits,
+        const std::vector<const Component *> &sources) {
+	auto archetype = getArchetype(bits);
+	const auto row = archetype->push(&entity);
+
+	// columns are ordered by component index, like the sources
+	for (std::size_t i = 0u; i < sources.size(); ++i) {
+		const auto &column = archetype->columns[i];
+
+		assert(column.operations.copyConstruct != nullptr && "copied components must be copy constructible");
+		column.operations.copyConstruct(archetype->getSlot(row, column), sources[i]);
+	}
+
+	entity.storage = this;
+	entity.archetype = archetype;
+	entity.archetypeRow = row;
+}
+
+void ashley::internal::ArchetypeStorage::erase(Entity &entity) {
+	auto moved = entity.archetype->erase(entity.archetypeRow);
+
+	if (moved != nullptr) {
+		moved->archetypeRow = entity.archetypeRow;
+	}
+
+	entity.storage = nullptr;
+	entity.archetype = nullptr;
+	entity.archetypeRow = 0u;
+}
+
+void ashley::internal::ArchetypeStorage::add(Entity &entity, ComponentPtr &&component,
+        uint64_t typeIndex) {
+	if (entity.componentBits[typeIndex]) {
+		// replacing an existing component doesn't change the archetype; the column's operations are used rather than
+		// looking the type up in the global registry, which is locked
+		const auto archetype = entity.archetype;
+		const auto &column = archetype->columns[archetype->columnLookup[typeIndex]];
+		auto slot = archetype->getSlot(entity.archetypeRow, column);
+
+		column.operations.destroy(slot);
+		column.operations.moveConstruct(slot, component.get());
+	} else {
+		auto bits = entity.componentBits;
+		bits.set(typeIndex, true);
+
+		moveEntity(entity, getArchetype(bits), typeIndex, component.get());
+	}
+
+	component.reset();
+}
+
+ashley::ComponentPtr ashley::internal::ArchetypeStorage::remove(Entity &entity, uint64_t typeIndex) {
+	const auto archetype = entity.archetype;
+	const auto &column = archetype->columns[archetype->columnLookup[typeIndex]];
+
+	ComponentPtr removed(column.operations.moveToHeap(archetype->getSlot(entity.archetypeRow, column)),
+	        ComponentDeleter(column.operations.deleteHeap));
+
+	auto bits = entity.componentBits;
+	bits.set(typeIndex, false);
+
+	moveEntity(entity, getArchetype(bits), typeIndex, nullptr);
+
+	return removed;
+}
+
+void ashley::internal::ArchetypeStorage::removeAll(Entity &entity) {
+	moveEntity(entity, getArchetype(BitsType()), 0u, nullptr);
+}
+
+void ashley::internal::ArchetypeStorage::moveEntity(Entity &entity, Archetype *destination, uint64_t addedIndex,
+        Component *added) {
+	auto source = entity.archetype;
+	const auto sourceRow = entity.archetypeRow;
+
+	if (source == destination) {
+		return;
+	}
+
+	const auto row = destination->push(&entity);
+
+	for (auto &column : destination->columns) {
+		auto slot = destination->getSlot(row, column);
+
+		if (added != nullptr && column.typeIndex == addedIndex) {
+			column.operations.moveConstruct(slot, added);
+		} else {
+			column.operations.moveConstruct(slot, source->getComponent(sourceRow, column.typeIndex));
+		}
+	}
+
+	entity.archetype = destination;
+	entity.archetypeRow = row;
+
+	// erasing destroys the moved-from components along with any component that was removed
+	auto moved = source->erase(sourceRow);
+
+	if (moved != nullptr) {
+		moved->archetypeRow = sourceRow;
+	}
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <bitset>
+
+#include "Ashley/util/Bits.hpp"
+
+const std::size_t ashley::Bits::npos = static_cast<std::size_t>(-1);
+
+bool ashley::Bits::any() const {
+	const auto words = getWords();
+	uint64_t combined = 0u;
+
+	for (std::size_t i = 0u; i < wordCount; ++i) {
+		combined |= words[i];
+	}
+
+	return combined != 0u;
+}
+
+std::size_t ashley::Bits::count() const {
+	const auto words = getWords();
+	std::size_t total = 0u;
+
+	for (std::size_t i = 0u; i < wordCount; ++i) {
+		total += popCount(words[i]);
+	}
+
+	return total;
+}
+
+std::size_t ashley::Bits::countBelow(std::size_t index) const {
+	const auto words = getWords();
+	const auto word = index / bitsPerWord;
+	const auto fullWords = std::min<std::size_t>(word, wordCount);
+
+	std::size_t total = 0u;
+
+	for (std::size_t i = 0u; i < fullWords; ++i) {
+		total += popCount(words[i]);
+	}
+
+	if (word < wordCount) {
+		total += popCount(words[word] & ((uint64_t(1) << (index % bitsPerWord)) - 1));
+	}
+
+	return total;
+}
+
+std::size_t ashley::Bits::nextSetBit(std::size_t from) const {
+	const auto words = getWords();
+	auto word = from / bitsPerWord;
+
+	if (word >= wordCount) {
+		return npos;
+	}
+
+	auto remaining = words[word] & (~uint64_t(0) << (from % bitsPerWord));
+
+	while (remaining == 0u) {
+		if (++word >= wordCount) {
+			return npos;
+		}
+
+		remaining = words[word];
+	}
+
+	return word * bitsPerWord + countTrailingZeros(remaining);
+}
+
+bool ashley::Bits::containsAll(const Bits &other) const {
+	const auto words = getWords();
+	const auto otherWords = other.getWords();
+	const auto common = std::min(wordCount, other.wordCount);
+
+	uint64_t missing = 0u;
+
+	for (std::size_t i = 0u; i < common; ++i) {
+		missing |= otherWords[i] & ~words[i];
+	}
+
+	for (std::size_t i = common; i < other.wordCount; ++i) {
+		missing |= otherWords[i];
+	}
+
+	return missing == 0u;
+}
+
+bool ashley::Bits::intersects(const Bits &other) const {
+	const auto words = getWords();
+	const auto otherWords = other.getWords();
+	const auto common = std::min(wordCount, other.wordCount);
+
+	uint64_t shared = 0u;
+
+	for (std::size_t i = 0u; i < common; ++i) {
+		shared |= words[i] & otherWords[i];
+	}
+
+	return shared != 0u;
+}
+
+ashley::Bits &ashley::Bits::operator&=(const Bits &other) {
+	auto words = getWords();
+	const auto otherWords = other.getWords();
+	const auto common = std::min(wordCount, other.wordCount);
+
+	for (std::size_t i = 0u; i < common; ++i) {
+		words[i] &= otherWords[i];
+	}
+
+	for (std::size_t i = common; i < wordCount; ++i) {
+		words[i] = 0u;
+	}
+
+	return *this;
+}
+
+ashley::Bits &ashley::Bits::operator|=(const Bits &other) {
+	if (other.wordCount > wordCount) {
+		grow(other.wordCount);
+	}
+
+	auto words = getWords();
+	const auto otherWords = other.getWords();
+
+	for (std::size_t i = 0u; i < other.wordCount; ++i) {
+		words[i] |= otherWords[i];
+	}
+
+	return *this;
+}
+
+ashley::Bits &ashley::Bits::andNot(const Bits &other) {
+	auto words = getWords();
+	const auto otherWords = other.getWords();
+	const auto common = std::min(wordCount, other.wordCount);
+
+	// bits beyond other's words are left as they are
+	for (std::size_t i = 0u; i < common; ++i) {
+		words[i] &= ~otherWords[i];
+	}
+
+	return *this;
+}
+
+bool ashley::Bits::operator==(const Bits &other) const {
+	const auto words = getWords();
+	const auto otherWords = other.getWords();
+	const auto common = std::min(wordCount, other.wordCount);
+
+	uint64_t difference = 0u;
+
+	for (std::size_t i = 0u; i < common; ++i) {
+		difference |= words[i] ^ otherWords[i];
+	}
+
+	for (std::size_t i = common; i < wordCount; ++i) {
+		difference |= words[i];
+	}
+
+	for (std::size_t i = common; i < other.wordCount; ++i) {
+		difference |= otherWords[i];
+	}
+
+	return difference == 0u;
+}
+
+std::size_t ashley::Bits::hash() const {
+	const auto words = getWords();
+	auto used = static_cast<std::size_t>(wordCount);
+
+	while (used > 0u && words[used - 1] == 0u) {
+		--used;
+	}
+
+	// FNV-1a over whole words, so that equal sets of bits hash equally whatever their size
+	uint64_t result = 14695981039346656037ull;
+
+	for (std::size_t i = 0u; i < used; ++i) {
+		result ^= words[i];
+		result *= 1099511628211ull;
+	}
+
+	return static_cast<std::size_t>(result ^ (result >> 32));
+}
+
+std::size_t ashley::Bits::popCount(uint64_t word) {
+#if defined(__GNUC__)
+	return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+	return std::bitset<64>(word).count();
+#endif
+}
+
+std::size_t ashley::Bits::countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__)
+	return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+	std::size_t zeros = 0u;
+
+	while ((word & 1u) == 0u) {
+		word >>= 1;
+		++zeros;
+	}
+
+	return zeros;
+#endif
+}
+
+void ashley::Bits::grow(std::size_t words) {
+	// grow geometrically so that setting increasing indices doesn't reallocate every time
+	const auto newCount = std::max<std::size_t>(words, wordCount * 2u);
+	auto newWords = new uint64_t[newCount];
+
+	std::memcpy(newWords, getWords(), wordCount * sizeof(uint64_t));
+	std::memset(newWords + wordCount, 0, (newCount - wordCount) * sizeof(uint64_t));
+
+	if (isHeap()) {
+		delete[] heapWords;
+	}
+
+	heapWords = newWords;
+	wordCount = static_cast<uint32_t>(newCount);
+}
+
+void ashley::Bits::copyFrom(const Bits &other) {
+	if (wordCount < other.wordCount) {
+		grow(other.wordCount);
+	}
+
+	auto words = getWords();
+
+	std::memcpy(words, other.getWords(), other.wordCount * sizeof(uint64_t));
+	std::memset(words + other.wordCount, 0, (wordCount - other.wordCount) * sizeof(uint64_t));
+}
@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Ashley/internal/ChangeTicks.hpp"
+
+void ashley::internal::ChangeTicks::track(uint64_t componentIndex, std::size_t slotCount) {
+	tracked.set(componentIndex);
+
+	if (ticks.size() <= componentIndex) {
+		ticks.resize(componentIndex + 1u);
+	}
+
+	if (ticks[componentIndex].size() < slotCount) {
+		ticks[componentIndex].resize(slotCount, 0u);
+	}
+}
+
+void ashley::internal::ChangeTicks::markAll(const BitsType &components, uint32_t slot, uint64_t tick) {
+	for (auto i = tracked.nextSetBit(0); i != BitsType::npos; i = tracked.nextSetBit(i + 1)) {
+		auto &componentTicks = ticks[i];
+
+		if (componentTicks.size() <= slot) {
+			componentTicks.resize(slot + 1u, 0u);
+		}
+
+		if (components[i]) {
+			componentTicks[slot] = tick;
+		}
+	}
+}
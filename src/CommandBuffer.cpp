@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <vector>
+
+#include "Ashley/internal/CommandBuffer.hpp"
+
+namespace {
+// the buffer structural changes made on this thread are queued into, while a system is updating
+thread_local ashley::internal::CommandBuffer *currentBuffer = nullptr;
+
+// the engine currentBuffer belongs to
+thread_local const ashley::Engine *currentEngine = nullptr;
+}
+
+ashley::internal::CommandBuffer::Scope::Scope(CommandBuffer &buffer, const Engine *engine) :
+		        previous(currentBuffer),
+		        previousEngine(currentEngine) {
+	currentBuffer = &buffer;
+	currentEngine = engine;
+}
+
+ashley::internal::CommandBuffer::Scope::~Scope() {
+	currentBuffer = previous;
+	currentEngine = previousEngine;
+}
+
+ashley::internal::CommandBuffer::~CommandBuffer() {
+	for (auto &operation : operations) {
+		if (operation.type == ComponentOperation::Type::ADD) {
+			operation.takeComponent();
+		}
+	}
+}
+
+ashley::internal::CommandBuffer *ashley::internal::CommandBuffer::getCurrent(const Engine *engine) {
+	return currentEngine == engine ? currentBuffer : nullptr;
+}
+
+void ashley::internal::CommandBuffer::append(CommandBuffer &other) {
+	addedEntities.insert(addedEntities.end(), other.addedEntities.begin(), other.addedEntities.end());
+	operations.insert(operations.end(), other.operations.begin(), other.operations.end());
+	removedEntities.insert(removedEntities.end(), other.removedEntities.begin(), other.removedEntities.end());
+
+	// ownership of any components moved along with the records
+	other.addedEntities.clear();
+	other.operations.clear();
+	other.removedEntities.clear();
+}
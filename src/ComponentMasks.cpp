@@ -0,0 +1,256 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASHLEY_MASKS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASHLEY_MASKS_SSE2
+#endif
+
+#include "Ashley/AshleyConstants.hpp"
+#include "Ashley/core/Family.hpp"
+#include "Ashley/internal/ComponentMasks.hpp"
+
+namespace {
+struct ColumnRequirement {
+	const uint64_t *words;
+
+	uint64_t all;
+	uint64_t one;
+	uint64_t exclude;
+};
+
+inline uint64_t getWord(const ashley::BitsType &bits, std::size_t word) {
+	return word < bits.getWordCount() ? bits.getWords()[word] : 0u;
+}
+
+inline bool matchesAt(const std::vector<ColumnRequirement> &requirements, std::size_t position, bool needOne,
+        bool needAny) {
+	uint64_t missing = 0u, hit = 0u, excluded = 0u, present = 0u;
+
+	for (const auto &requirement : requirements) {
+		const auto mask = requirement.words[position];
+
+		missing |= requirement.all & ~mask;
+		hit |= requirement.one & mask;
+		excluded |= requirement.exclude & mask;
+		present |= mask;
+	}
+
+	return missing == 0u && excluded == 0u && (!needOne || hit != 0u) && (!needAny || present != 0u);
+}
+
+#if defined(ASHLEY_MASKS_SSE2)
+// SSE2 has no 64-bit compare, so a 64-bit lane is zero if both of its 32-bit halves are
+inline int zeroLanes(__m128i value) {
+	const auto halves = _mm_cmpeq_epi32(value, _mm_setzero_si128());
+	const auto lanes = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_movemask_pd(_mm_castsi128_pd(lanes));
+}
+#endif
+}
+
+void ashley::internal::ComponentMasks::reserve(std::size_t capacity) {
+	for (auto &column : columns) {
+		column.reserve(capacity);
+	}
+}
+
+void ashley::internal::ComponentMasks::push_back(const BitsType &bits) {
+	for (auto &column : columns) {
+		column.push_back(0u);
+	}
+
+	count++;
+	assign(count - 1, bits);
+}
+
+void ashley::internal::ComponentMasks::assign(std::size_t position, const BitsType &bits) {
+	const auto words = bits.getWords();
+	auto wordCount = bits.getWordCount();
+
+	// trailing zero words don't need columns of their own
+	while (wordCount > 0u && words[wordCount - 1] == 0u) {
+		wordCount--;
+	}
+
+	ensureColumns(wordCount);
+
+	for (std::size_t w = 0u; w < columns.size(); w++) {
+		columns[w][position] = (w < wordCount ? words[w] : 0u);
+	}
+}
+
+void ashley::internal::ComponentMasks::set(std::size_t position, uint64_t componentIndex, bool value) {
+	const auto word = componentIndex / 64u;
+	const auto mask = uint64_t(1u) << (componentIndex % 64u);
+
+	if (value) {
+		ensureColumns(word + 1);
+		columns[word][position] |= mask;
+	} else if (word < columns.size()) {
+		columns[word][position] &= ~mask;
+	}
+}
+
+void ashley::internal::ComponentMasks::swapAndPop(std::size_t position) {
+	for (auto &column : columns) {
+		column[position] = column.back();
+		column.pop_back();
+	}
+
+	count--;
+}
+
+void ashley::internal::ComponentMasks::clear() {
+	columns.clear();
+	count = 0u;
+}
+
+void ashley::internal::ComponentMasks::ensureColumns(std::size_t columnCount) {
+	if (columns.size() < columnCount) {
+		columns.resize(columnCount, std::vector<uint64_t>(count, 0u));
+	}
+}
+
+void ashley::internal::ComponentMasks::match(const Family &family, std::vector<std::size_t> &matches) const {
+	const auto &all = family.getAll();
+	const auto &one = family.getOne();
+	const auto &exclude = family.getExclude();
+
+	// no mask has any bits beyond the stored columns, so an entity with no components is all that's left and that
+	// never matches
+	if (count == 0u || columns.empty()) {
+		return;
+	}
+
+	for (auto w = columns.size(); w < all.getWordCount(); w++) {
+		if (all.getWords()[w] != 0u) {
+			return;
+		}
+	}
+
+	const bool needOne = one.any();
+
+	// a family requiring nothing still doesn't match an entity with no components
+	const bool needAny = all.none() && !needOne;
+
+	std::vector<ColumnRequirement> requirements;
+	bool oneInRange = false;
+
+	for (std::size_t w = 0u; w < columns.size(); w++) {
+		const ColumnRequirement requirement { columns[w].data(), getWord(all, w), getWord(one, w), getWord(exclude,
+		        w) };
+
+		oneInRange = oneInRange || requirement.one != 0u;
+
+		if (needAny || (requirement.all | requirement.one | requirement.exclude) != 0u) {
+			requirements.push_back(requirement);
+		}
+	}
+
+	if (needOne && !oneInRange) {
+		return;
+	}
+
+	std::size_t i = 0u;
+
+#if defined(ASHLEY_MASKS_AVX2)
+	const auto zero = _mm256_setzero_si256();
+
+	for (; i + 4u <= count; i += 4u) {
+		auto missing = zero, hit = zero, excluded = zero, present = zero;
+
+		for (const auto &requirement : requirements) {
+			const auto masks = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(requirement.words + i));
+
+			missing = _mm256_or_si256(missing,
+			        _mm256_andnot_si256(masks, _mm256_set1_epi64x(static_cast<long long>(requirement.all))));
+			hit = _mm256_or_si256(hit,
+			        _mm256_and_si256(masks, _mm256_set1_epi64x(static_cast<long long>(requirement.one))));
+			excluded = _mm256_or_si256(excluded,
+			        _mm256_and_si256(masks, _mm256_set1_epi64x(static_cast<long long>(requirement.exclude))));
+			present = _mm256_or_si256(present, masks);
+		}
+
+		const auto failed = _mm256_or_si256(missing, excluded);
+		auto lanes = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(failed, zero)));
+
+		if (needOne) {
+			lanes &= ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hit, zero)));
+		}
+
+		if (needAny) {
+			lanes &= ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(present, zero)));
+		}
+
+		for (std::size_t lane = 0u; lanes != 0; lane++, lanes >>= 1) {
+			if ((lanes & 1) != 0) {
+				matches.push_back(i + lane);
+			}
+		}
+	}
+#elif defined(ASHLEY_MASKS_SSE2)
+	const auto zero = _mm_setzero_si128();
+
+	for (; i + 2u <= count; i += 2u) {
+		auto missing = zero, hit = zero, excluded = zero, present = zero;
+
+		for (const auto &requirement : requirements) {
+			const auto masks = _mm_loadu_si128(reinterpret_cast<const __m128i *>(requirement.words + i));
+
+			missing = _mm_or_si128(missing,
+			        _mm_andnot_si128(masks, _mm_set1_epi64x(static_cast<long long>(requirement.all))));
+			hit = _mm_or_si128(hit, _mm_and_si128(masks, _mm_set1_epi64x(static_cast<long long>(requirement.one))));
+			excluded = _mm_or_si128(excluded,
+			        _mm_and_si128(masks, _mm_set1_epi64x(static_cast<long long>(requirement.exclude))));
+			present = _mm_or_si128(present, masks);
+		}
+
+		auto lanes = zeroLanes(_mm_or_si128(missing, excluded));
+
+		if (needOne) {
+			lanes &= ~zeroLanes(hit);
+		}
+
+		if (needAny) {
+			lanes &= ~zeroLanes(present);
+		}
+
+		if ((lanes & 1) != 0) {
+			matches.push_back(i);
+		}
+
+		if ((lanes & 2) != 0) {
+			matches.push_back(i + 1u);
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		if (matchesAt(requirements, i, needOne, needAny)) {
+			matches.push_back(i);
+		}
+	}
+}
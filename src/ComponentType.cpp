@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <mutex>
 #include <unordered_map>
 #include <typeinfo>
 #include <typeindex>
@@ -28,14 +29,41 @@
 
 uint64_t ashley::ComponentType::typeIndex = 0;
 std::unordered_map<std::type_index, ashley::ComponentType> ashley::ComponentType::componentTypes;
+std::vector<ashley::ComponentType *> ashley::ComponentType::typesByIndex;
+
+namespace {
+// guards componentTypes and typesByIndex, since components can be added from several threads at once
+std::mutex registryMutex;
+}
 
 ashley::ComponentType::ComponentType() :
-		        index(typeIndex++) {
+		        index(typeIndex++),
+		        operations() {
 }
 
 ashley::ComponentType& ashley::ComponentType::getFor(std::type_index index) {
-	// if the given index doesn't exist it's created by the container
-	return componentTypes[index];
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	auto it = componentTypes.find(index);
+
+	if (it == componentTypes.end()) {
+		it = componentTypes.emplace(index, ComponentType()).first;
+
+		// map nodes are never moved so the pointer stays valid
+		auto &type = it->second;
+		if (typesByIndex.size() <= type.index) {
+			typesByIndex.resize(type.index + 1, nullptr);
+		}
+
+		typesByIndex[type.index] = &type;
+	}
+
+	return it->second;
+}
+
+const ashley::ComponentType *ashley::ComponentType::getByIndex(uint64_t index) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return index < typesByIndex.size() ? typesByIndex[index] : nullptr;
 }
 
 uint64_t ashley::ComponentType::getIndexFor(std::type_index index) {
@@ -45,7 +73,7 @@ uint64_t ashley::ComponentType::getIndexFor(std::type_index index) {
 ashley::BitsType ashley::ComponentType::getBitsFor(std::initializer_list<std::type_index> components) {
 	ashley::BitsType retVal;
 	std::for_each(components.begin(), components.end(),
-	        [&](std::type_index i) {retVal[ashley::ComponentType::getIndexFor(i)] = true;});
+	        [&](std::type_index i) {retVal.set(ashley::ComponentType::getIndexFor(i));});
 
 	return retVal;
 }
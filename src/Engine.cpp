@@ -1,34 +1,56 @@
 #include <cassert>
+#include <cstdint>
 
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <algorithm>
 #include <typeindex>
 
 #include "Ashley/core/Engine.hpp"
 
-ashley::Engine::Engine() :
+ashley::Engine::Engine(StorageMode storageMode) :
+		        storageMode(storageMode),
+		        archetypeStorage(nullptr),
+		        entityPool(ASHLEY_ENTITY_BLOCK_SIZE),
 		        notifying(false),
 		        updating(false),
-		        operationPool(100) {
-	componentAddedListener = std::unique_ptr<AddedListener>(new AddedListener(this));
-	componentRemovedListener = std::unique_ptr<RemovedListener>(new RemovedListener(this));
-
+		        deferFamilyUpdates(false),
+		        runningSystems(false),
+		        deferredMutex(new std::mutex()),
+		        familyMutex(new std::mutex()) {
 	operationHandler = std::unique_ptr<EngineOperationHandler>(new EngineOperationHandler(this));
+
+	if (storageMode == StorageMode::ARCHETYPE) {
+		archetypeStorage = std::unique_ptr<internal::ArchetypeStorage>(
+		        new internal::ArchetypeStorage(ASHLEY_ARCHETYPE_CHUNK_SIZE));
+	}
 }
 
 ashley::Engine::~Engine() {
-	for (auto &op : operationVector) {
-		operationPool.free(op);
+	listeners.clear();
+	removalPendingListeners.clear();
+
+	// entities queued for adding are only left over if an update was interrupted
+	for (auto &buffer : commandBuffers) {
+		for (auto entity : buffer.addedEntities) {
+			destroyEntity(entity);
+		}
 	}
 
-	operationVector.clear();
-	listeners.clear();
+	for (auto entity : sharedCommands.addedEntities) {
+		destroyEntity(entity);
+	}
+
+	commandBuffers.clear();
+
+	for (auto entity : entities) {
+		destroyEntity(entity);
+	}
 
-	pendingRemovalEntities.clear();
-	removalPendingListeners.clear();
 	entities.clear();
+	componentMasks.clear();
 	families.clear();
 
 	systems.clear();
@@ -36,14 +58,52 @@ ashley::Engine::~Engine() {
 }
 
 ashley::Entity *ashley::Engine::addEntity(std::unique_ptr<Entity> &&ptr) {
-	entities.emplace_back(std::move(ptr));
+	if (updating) {
+		std::unique_lock<std::mutex> lock;
+		getCommandBuffer(lock).addedEntities.push_back(ptr.get());
+		return ptr.release();
+	}
 
-	auto &added = entities.back();
+	return addEntityInternal(ptr.release());
+}
+
+ashley::Entity *ashley::Engine::addEntity() {
+	if (updating) {
+		Entity *entity = nullptr;
+
+		{
+			// the pool is shared by every thread, so taking an entity from it is the one step which locks
+			std::lock_guard<std::mutex> lock(*deferredMutex);
+			entity = entityPool.obtain();
+		}
+
+		entity->pooled = true;
+
+		std::unique_lock<std::mutex> lock;
+		getCommandBuffer(lock).addedEntities.push_back(entity);
+		return entity;
+	}
+
+	auto entity = entityPool.obtain();
+	entity->pooled = true;
+
+	return addEntityInternal(entity);
+}
+
+ashley::Entity *ashley::Engine::addEntityInternal(Entity *added) {
+	added->engineIndex = entities.size();
+	added->handle = allocateHandle(added);
+	entities.push_back(added);
+	componentMasks.push_back(added->componentBits);
+	changeTicks.markAll(added->componentBits, added->handle.index, changeTick);
+
+	if (archetypeStorage != nullptr) {
+		archetypeStorage->insert(*added);
+	}
 
 	updateFamilyMembership(*added);
 
-	added->componentAdded.add((Listener<Entity>*) componentAddedListener.get());
-	added->componentRemoved.add((Listener<Entity>*) componentRemovedListener.get());
+	added->engine = this;
 	added->operationHandler = operationHandler.get();
 
 	notifying = true;
@@ -55,27 +115,168 @@ ashley::Entity *ashley::Engine::addEntity(std::unique_ptr<Entity> &&ptr) {
 	notifying = false;
 	removePendingListeners();
 
-	return added.get();
+	return added;
 }
 
-ashley::Entity *ashley::Engine::addEntity() {
-	return addEntity(std::unique_ptr<Entity>(new Entity()));
+void ashley::Engine::obtainEntities(std::size_t count, std::vector<Entity *> &obtained) {
+	obtained.reserve(obtained.size() + count);
+
+	{
+		std::unique_lock<std::mutex> lock;
+
+		if (updating) {
+			lock = std::unique_lock<std::mutex>(*deferredMutex);
+		}
+
+		for (std::size_t i = 0u; i < count; ++i) {
+			obtained.push_back(entityPool.obtain());
+		}
+	}
+
+	for (auto entity : obtained) {
+		entity->pooled = true;
+	}
+}
+
+ashley::Entity *ashley::Engine::instantiate(const Prefab &prefab) {
+	std::vector<Entity *> added;
+	obtainEntities(1u, added);
+	copyPrefab(prefab, added);
+	addEntitiesInternal(added);
+
+	return added.front();
+}
+
+void ashley::Engine::instantiate(const Prefab &prefab, std::size_t count) {
+	instantiate(prefab, count, [](Entity &, std::size_t) {});
+}
+
+void ashley::Engine::copyPrefab(const Prefab &prefab, const std::vector<Entity *> &entities) {
+	// archetype storage isn't safe to use from other threads during an update, so entities added then are copied into
+	// individual components and moved into their archetype once they're added
+	if (archetypeStorage != nullptr && !updating) {
+		std::vector<const Component *> sources;
+		sources.reserve(prefab.prototypes.size());
+
+		for (auto &prototype : prefab.prototypes) {
+			sources.push_back(prototype.component.get());
+		}
+
+		for (auto entity : entities) {
+			archetypeStorage->insertCopy(*entity, prefab.componentBits, sources);
+			entity->componentBits = prefab.componentBits;
+		}
+	} else {
+		// individually stored components are still cloned one at a time: each can be removed on its own and goes back
+		// to its type's pool when it is, so they can't share one block per entity. the clones come from those pools
+		// rather than the heap, so this is one pool allocation per component
+		for (auto entity : entities) {
+			entity->components.reserve(prefab.prototypes.size());
+
+			for (auto &prototype : prefab.prototypes) {
+				entity->components.push_back(prototype.clone(*prototype.component));
+			}
+
+			entity->componentBits = prefab.componentBits;
+		}
+	}
+}
+
+void ashley::Engine::addEntitiesInternal(const std::vector<Entity *> &added) {
+	if (updating) {
+		std::unique_lock<std::mutex> lock;
+		auto &queued = getCommandBuffer(lock).addedEntities;
+		queued.insert(queued.end(), added.begin(), added.end());
+	} else {
+		addEntityBatch(added);
+	}
+}
+
+void ashley::Engine::addEntityBatch(const std::vector<Entity *> &added) {
+	if (added.empty()) {
+		return;
+	}
+
+	entities.reserve(entities.size() + added.size());
+	componentMasks.reserve(entities.size() + added.size());
+
+	for (auto entity : added) {
+		entity->engineIndex = entities.size();
+		entity->handle = allocateHandle(entity);
+		entities.push_back(entity);
+		componentMasks.push_back(entity->componentBits);
+		changeTicks.markAll(entity->componentBits, entity->handle.index, changeTick);
+
+		// entities copied from a prefab can already be stored
+		if (archetypeStorage != nullptr && entity->storage == nullptr) {
+			archetypeStorage->insert(*entity);
+		}
+	}
+
+	// batches are usually made of runs of entities with the same components, which all match the same families
+	std::vector<internal::FamilyMembers *> matching;
+	const BitsType *matchedBits = nullptr;
+
+	for (auto entity : added) {
+		if (matchedBits == nullptr || *matchedBits != entity->componentBits) {
+			matching.clear();
+
+			for (auto &members : families) {
+				if (members->getFamily().matches(entity->componentBits)) {
+					matching.push_back(members.get());
+				}
+			}
+
+			matchedBits = &entity->componentBits;
+		}
+
+		for (auto members : matching) {
+			members->add(*entity, entity->handle.index);
+		}
+
+		entity->engine = this;
+		entity->operationHandler = operationHandler.get();
+	}
+
+	notifying = true;
+
+	for (auto &listener : listeners) {
+		listener->entitiesAdded(added);
+	}
+
+	notifying = false;
+	removePendingListeners();
 }
 
 void ashley::Engine::removeEntity(Entity * const ptr) {
 	if (updating) {
-		pendingRemovalEntities.push_back(ptr);
+		std::unique_lock<std::mutex> lock;
+		getCommandBuffer(lock).removedEntities.push_back(ptr);
 	} else {
 		removeEntityInternal(ptr);
 	}
 }
 
-void ashley::Engine::removeAllEntities() {
-	while (!entities.empty()) {
-		removeEntity(entities.front().get());
+void ashley::Engine::removeEntities(const std::vector<Entity *> &removed) {
+	if (updating) {
+		std::unique_lock<std::mutex> lock;
+		auto &queued = getCommandBuffer(lock).removedEntities;
+		queued.insert(queued.end(), removed.begin(), removed.end());
+	} else {
+		removeEntityBatch(removed);
 	}
 }
 
+void ashley::Engine::removeAllEntities() {
+	// copied since removing entities reorders the engine's own list; going from the back means every entity and
+	// family member removed is the last one, so nothing has to be moved into its place
+	removeEntities(std::vector<Entity *>(entities.rbegin(), entities.rend()));
+}
+
+void ashley::Engine::removeEntitiesFor(Family *family) {
+	removeEntities(std::vector<Entity *>(*getEntitiesFor(family)));
+}
+
 ashley::EntitySystem *ashley::Engine::addSystem(std::unique_ptr<EntitySystem> &&system) {
 	// Produces a warning about side-effects because of the dereference inside typeid.
 	// Annoying, but isn't a problem since dereferencing a unique_ptr is
@@ -118,22 +319,83 @@ ashley::EntitySystem * ashley::Engine::getSystem(std::type_index systemType) con
 }
 
 std::vector<ashley::Entity *> *ashley::Engine::getEntitiesFor(Family * const family) {
-	auto vecIt = families.find(*family);
+	return &getFamilyMembers(family).getEntities();
+}
 
-	if (vecIt == families.end()) {
-		std::vector<ashley::Entity *> entVec;
+ashley::internal::FamilyMembers &ashley::Engine::getFamilyMembers(Family * const family) {
+	// families are unique per set of bits, so the family's address identifies it; familiesByPointer isn't changed
+	// while systems are running, so it can be read without locking
+	auto it = familiesByPointer.find(family);
 
-		for (auto &ptr : entities) {
-			if (family->matches(*ptr)) {
-				entVec.emplace_back(ptr.get());
-				ptr->getFamilyBits().set(family->getIndex(), true);
+	if (it != familiesByPointer.end()) {
+		return *it->second;
+	}
+
+	if (runningSystems) {
+		// systems can run on several threads, so families first requested by them are kept aside under a lock and
+		// only registered once every system has finished; entities can't be added or removed until then
+		std::lock_guard<std::mutex> lock(*familyMutex);
+
+		for (auto &pending : pendingFamilies) {
+			if (&pending->getFamily() == family) {
+				return *pending;
 			}
 		}
 
-		families.insert(std::pair<ashley::Family, std::vector<ashley::Entity *>>(*family, entVec));
+		pendingFamilies.push_back(createFamilyMembers(*family, families.size() + pendingFamilies.size()));
+		return *pendingFamilies.back();
+	}
+
+	return registerFamily(createFamilyMembers(*family, families.size()));
+}
+
+std::unique_ptr<ashley::internal::FamilyMembers> ashley::Engine::createFamilyMembers(const Family &family,
+        std::size_t id) const {
+	std::unique_ptr<internal::FamilyMembers> members(new internal::FamilyMembers(family, id));
+
+	std::vector<std::size_t> matches;
+	componentMasks.match(family, matches);
+
+	members->getEntities().reserve(matches.size());
+
+	for (auto position : matches) {
+		auto &entity = *entities[position];
+		members->add(entity, entity.handle.index);
+	}
+
+	return members;
+}
+
+ashley::internal::FamilyMembers &ashley::Engine::registerFamily(std::unique_ptr<internal::FamilyMembers> &&members) {
+	auto &registered = *members;
+
+	familiesByPointer.emplace(&registered.getFamily(), &registered);
+	families.push_back(std::move(members));
+	indexFamily(registered);
+
+	return registered;
+}
+
+void ashley::Engine::registerPendingFamilies() {
+	for (auto &pending : pendingFamilies) {
+		registerFamily(std::move(pending));
 	}
 
-	return &(families[*family]);
+	pendingFamilies.clear();
+}
+
+std::vector<ashley::Archetype *> ashley::Engine::getArchetypesFor(Family * const family) const {
+	std::vector<ashley::Archetype *> ret;
+
+	if (archetypeStorage != nullptr) {
+		for (auto archetype : archetypeStorage->getArchetypes()) {
+			if (archetype->size() > 0u && family->matches(archetype->getComponentBits())) {
+				ret.emplace_back(archetype);
+			}
+		}
+	}
+
+	return ret;
 }
 
 const std::vector<ashley::EntitySystem *> ashley::Engine::getSystems() const {
@@ -159,85 +421,286 @@ void ashley::Engine::removeEntityListener(ashley::EntityListener *listener) {
 	}
 }
 
+void ashley::Engine::setThreadCount(std::size_t threadCount) {
+	systemScheduler = nullptr;
+	threadPool = nullptr;
+
+	if (threadCount > 0u) {
+		threadPool = std::unique_ptr<ThreadPool>(new ThreadPool(threadCount));
+		systemScheduler = std::unique_ptr<internal::SystemScheduler>(new internal::SystemScheduler(*threadPool));
+	}
+}
+
 void ashley::Engine::update(float deltaTime) {
 	updating = true;
+	++changeTick;
+
+	commandBuffers.resize(systems.size());
 
-	for (auto &ptr : systems) {
-		if (ptr->checkProcessing()) {
-			ptr->update(deltaTime);
+	runningSystems = true;
+
+	if (systemScheduler != nullptr) {
+		systemScheduler->update(systems, commandBuffers, deltaTime);
+	} else {
+		for (std::size_t i = 0u; i < commandBuffers.size(); ++i) {
+			if (systems[i]->checkProcessing()) {
+				internal::CommandBuffer::Scope scope(commandBuffers[i], this);
+				systems[i]->update(deltaTime);
+			}
 		}
 	}
 
-	processComponentOperations();
-	removePendingEntities();
+	runningSystems = false;
+	registerPendingFamilies();
+
+	processCommandBuffers();
 	updating = false;
 }
 
+void ashley::Engine::trackChanges(uint64_t componentIndex) {
+	assert(!updating && "change tracking can't be enabled during an update");
+
+	if (changeTicks.isTracked(componentIndex)) {
+		return;
+	}
+
+	changeTicks.track(componentIndex, entitySlots.size());
+
+	for (auto entity : entities) {
+		if (entity->componentBits[componentIndex]) {
+			changeTicks.mark(componentIndex, entity->handle.index, changeTick);
+		}
+	}
+}
+
 bool ashley::Engine::systemPriorityComparator(const std::unique_ptr<EntitySystem> &one,
         const std::unique_ptr<EntitySystem> &other) {
 	return (*one) < (*other);
 }
 
+void ashley::Engine::setDeferFamilyUpdates(bool deferFamilyUpdates) {
+	this->deferFamilyUpdates = deferFamilyUpdates;
+
+	if (!deferFamilyUpdates) {
+		updateFamilies();
+	}
+}
+
+void ashley::Engine::updateFamilies() {
+	for (auto &dirty : dirtyEntities) {
+		// entities removed since being marked no longer resolve and are skipped
+		auto entity = getEntity(dirty.handle);
+
+		if (entity != nullptr) {
+			entity->dirtyIndex = 0u;
+			updateFamilyMembership(*entity, dirty.changedComponents);
+		}
+	}
+
+	dirtyEntities.clear();
+}
+
+void ashley::Engine::componentChanged(ashley::Entity &entity, uint64_t componentIndex) {
+	if (!ownsEntity(entity)) {
+		return;
+	}
+
+	componentMasks.set(entity.engineIndex, componentIndex, entity.componentBits[componentIndex]);
+
+	if (entity.componentBits[componentIndex]) {
+		changeTicks.mark(componentIndex, entity.handle.index, changeTick);
+	}
+
+	if (!deferFamilyUpdates) {
+		updateFamilyMembership(entity, componentIndex);
+	} else {
+		markDirty(entity).changedComponents.set(componentIndex, true);
+	}
+}
+
+void ashley::Engine::componentsChanged(ashley::Entity &entity, const BitsType &changedComponents) {
+	if (!ownsEntity(entity)) {
+		return;
+	}
+
+	componentMasks.assign(entity.engineIndex, entity.componentBits);
+
+	if (!deferFamilyUpdates) {
+		updateFamilyMembership(entity, changedComponents);
+	} else {
+		markDirty(entity).changedComponents |= changedComponents;
+	}
+}
+
+ashley::Engine::DirtyEntity &ashley::Engine::markDirty(ashley::Entity &entity) {
+	if (entity.dirtyIndex == 0u) {
+		dirtyEntities.push_back(DirtyEntity { entity.handle, BitsType() });
+		entity.dirtyIndex = dirtyEntities.size();
+	}
+
+	return dirtyEntities[entity.dirtyIndex - 1];
+}
+
 void ashley::Engine::updateFamilyMembership(ashley::Entity &entity) {
 	// note that this requires that the entity has already been added to the entities vector.
-	auto it = std::find_if(entities.begin(), entities.end(),
-	        [&](std::unique_ptr<ashley::Entity> &ptr) {return ptr->getIndex() == entity.getIndex();});
-
-	if (it == entities.end()) {
+	if (!ownsEntity(entity)) {
 		// not the end of the world if we had a bad call, probably smells of things getting destroyed incorrectly.
 		return;
 	}
 
-	auto &entPtr = *it;
+	for (auto &members : families) {
+		updateFamilyMembership(entity, *members);
+	}
+}
 
-	for (auto &pair : families) {
-		const auto &family = pair.first;
-		auto &vec = pair.second;
+void ashley::Engine::updateFamilyMembership(ashley::Entity &entity, uint64_t componentIndex) {
+	if (!ownsEntity(entity)) {
+		return;
+	}
 
-		const bool belongsToFamily = entPtr->getFamilyBits()[family.getIndex()];
-		const bool matches = family.matches(entity);
+	if (componentIndex < familiesByComponent.size()) {
+		for (auto entry : familiesByComponent[componentIndex]) {
+			updateFamilyMembership(entity, *entry);
+		}
+	}
 
-		if (!belongsToFamily && matches) {
-			vec.push_back(entPtr.get());
-			entPtr->getFamilyBits()[family.getIndex()] = true;
-		} else if (belongsToFamily && !matches) {
-			auto familyIt = std::find_if(vec.begin(), vec.end(), [&](Entity * const &found) {return *found == entity;});
-			entPtr->getFamilyBits()[family.getIndex()] = false;
+	for (auto entry : unindexedFamilies) {
+		updateFamilyMembership(entity, *entry);
+	}
+}
 
-			if (familyIt != vec.end()) {
-				vec.erase(familyIt);
-			}
+void ashley::Engine::updateFamilyMembership(ashley::Entity &entity, const BitsType &changedComponents) {
+	if (!ownsEntity(entity)) {
+		return;
+	}
+
+	collectAffectedFamilies(changedComponents, changedComponents.any());
+
+	for (auto members : affectedFamilies) {
+		updateFamilyMembership(entity, *members);
+	}
+}
+
+void ashley::Engine::updateFamilyMembership(ashley::Entity &entity, internal::FamilyMembers &members) {
+	const auto slot = entity.handle.index;
+
+	const bool belongsToFamily = members.contains(slot);
+	const bool matches = members.getFamily().matches(entity);
+
+	if (!belongsToFamily && matches) {
+		members.add(entity, slot);
+	} else if (belongsToFamily && !matches) {
+		members.remove(slot);
+	}
+}
+
+void ashley::Engine::collectAffectedFamilies(const BitsType &components, bool includeUnindexed) {
+	// a family mentioning several of the components must still only appear once
+	affectedFamilies.clear();
+
+	for (auto i = components.nextSetBit(0); i < familiesByComponent.size(); i = components.nextSetBit(i + 1)) {
+		const auto &indexed = familiesByComponent[i];
+		affectedFamilies.insert(affectedFamilies.end(), indexed.begin(), indexed.end());
+	}
+
+	if (includeUnindexed) {
+		affectedFamilies.insert(affectedFamilies.end(), unindexedFamilies.begin(), unindexedFamilies.end());
+	}
+
+	std::sort(affectedFamilies.begin(), affectedFamilies.end());
+	affectedFamilies.erase(std::unique(affectedFamilies.begin(), affectedFamilies.end()), affectedFamilies.end());
+}
+
+void ashley::Engine::indexFamily(internal::FamilyMembers &members) {
+	const auto &family = members.getFamily();
+
+	// an entity with no components never matches a family, so a family which requires no components can start or
+	// stop matching when any component changes
+	if (family.getAll().none() && family.getOne().none()) {
+		unindexedFamilies.push_back(&members);
+	}
+
+	const auto mentioned = family.getAll() | family.getOne() | family.getExclude();
+
+	for (auto i = mentioned.nextSetBit(0); i != BitsType::npos; i = mentioned.nextSetBit(i + 1)) {
+		if (familiesByComponent.size() <= i) {
+			familiesByComponent.resize(i + 1);
 		}
+
+		familiesByComponent[i].push_back(&members);
 	}
 }
 
-void ashley::Engine::processComponentOperations() {
-	const auto numOperations = operationVector.size();
+ashley::internal::CommandBuffer &ashley::Engine::getCommandBuffer(std::unique_lock<std::mutex> &lock) {
+	auto current = internal::CommandBuffer::getCurrent(this);
+
+	if (current != nullptr) {
+		return *current;
+	}
+
+	lock = std::unique_lock<std::mutex>(*deferredMutex);
+	return sharedCommands;
+}
+
+void ashley::Engine::processCommandBuffers() {
+	// listeners notified while applying changes queue any changes of their own into sharedCommands, which is always
+	// applied last in each step; anything queued for a step which has already passed is picked up by going round again.
+	// listeners run on this thread, so only changes queued from other threads while systems ran can make the order of
+	// sharedCommands depend on timing
+	do {
+		for (std::size_t b = 0u; b <= commandBuffers.size(); ++b) {
+			auto &buffer = b < commandBuffers.size() ? commandBuffers[b] : sharedCommands;
+
+			// swapped out so that listeners can queue more entities while the batch is being added
+			addedBatch.swap(buffer.addedEntities);
+			addEntityBatch(addedBatch);
+			addedBatch.clear();
+		}
+
+		for (std::size_t b = 0u; b <= commandBuffers.size(); ++b) {
+			processComponentOperations(b < commandBuffers.size() ? commandBuffers[b] : sharedCommands);
+		}
+
+		updateFamilies();
 
-	for (size_t i = 0u; i < numOperations; i++) {
-		auto operation = operationVector[i];
+		for (std::size_t b = 0u; b <= commandBuffers.size(); ++b) {
+			auto &buffer = b < commandBuffers.size() ? commandBuffers[b] : sharedCommands;
 
-		switch (operation->type) {
+			removedBatch.swap(buffer.removedEntities);
+			removeEntityBatch(removedBatch);
+			removedBatch.clear();
+		}
+	} while (!sharedCommands.empty());
+}
+
+void ashley::Engine::processComponentOperations(internal::CommandBuffer &buffer) {
+	// records are copied out since the buffer may reallocate if replaying queues more operations
+	for (size_t i = 0u; i < buffer.operations.size(); i++) {
+		auto operation = buffer.operations[i];
+		auto entity = getEntity(operation.entity);
+
+		switch (operation.type) {
 		case ComponentOperation::Type::ADD: {
-			operation->entity->addInternal(std::move(operation->component), *(operation->typeIndex));
+			auto component = operation.takeComponent();
+
+			if (entity != nullptr) {
+				entity->addInternal(std::move(component), operation.componentIndex);
+			}
+
 			break;
 		}
 
 		case ComponentOperation::Type::REMOVE: {
-			operation->entity->removeInternal(*(operation->typeIndex));
-			break;
-		}
+			if (entity != nullptr) {
+				entity->removeInternal(operation.componentIndex);
+			}
 
-		case ComponentOperation::Type::NONE: {
-			assert(false);
 			break;
 		}
 		}
-
-		operationPool.free(operation);
 	}
 
-	operationVector.clear();
+	buffer.operations.clear();
 }
 
 void ashley::Engine::removePendingListeners() {
@@ -252,76 +715,190 @@ void ashley::Engine::removePendingListeners() {
 	removalPendingListeners.clear();
 }
 
-void ashley::Engine::removePendingEntities() {
-	const auto numPending = pendingRemovalEntities.size();
-
-	for (size_t i = 0u; i < numPending; i++) {
-		removeEntityInternal(pendingRemovalEntities[i]);
+void ashley::Engine::removeEntityInternal(Entity * entity) {
+	// entities which are already being removed have been detached from the engine
+	if (!ownsEntity(*entity) || entity->engine != this) {
+		return;
 	}
 
-	pendingRemovalEntities.clear();
-}
+	detachEntity(*entity);
 
-void ashley::Engine::removeEntityInternal(Entity * entity) {
-	auto it = std::find_if(entities.begin(), entities.end(),
-						   [&](std::unique_ptr<Entity> &ptr) {return ptr.get() == entity;});
+	notifying = true;
 
-	if (it == entities.end()) {
-		return;
+	for (EntityListener *listener : listeners) {
+		listener->entityRemoved(*entity);
 	}
 
-	entity->componentAdded.remove(componentAddedListener.get());
-	entity->componentRemoved.remove(componentRemovedListener.get());
-	entity->operationHandler = nullptr;
+	notifying = false;
 
-	if (!entity->getFamilyBits().none()) {
-		for (auto &entry : families) {
-			const auto &family = entry.first;
-			auto &vec = entry.second;
+	removePendingListeners();
 
-			if (family.matches(*entity)) {
-				auto familyIt = std::find_if(vec.begin(), vec.end(), [&](Entity *const &ptr) {return ptr == entity;});
+	eraseEntity(entity);
+}
 
-				if (familyIt != vec.end()) {
-					vec.erase(familyIt);
-				}
+void ashley::Engine::removeEntityBatch(const std::vector<Entity *> &removed) {
+	std::vector<Entity *> detached;
+	detached.reserve(removed.size());
 
-				entity->getFamilyBits()[family.getIndex()] = 0;
-			}
+	// entities listed twice are only detached once
+	for (auto entity : removed) {
+		if (ownsEntity(*entity) && entity->engine == this) {
+			entity->engine = nullptr;
+			entity->operationHandler = nullptr;
+			detached.push_back(entity);
 		}
 	}
 
+	if (detached.empty()) {
+		return;
+	}
+
+	if (detached.size() == entities.size()) {
+		// removing everything, so every family can simply be emptied
+		for (auto &members : families) {
+			members->clear();
+		}
+
+		for (auto entity : detached) {
+			entity->dirtyIndex = 0u;
+		}
+	} else {
+		for (auto entity : detached) {
+			removeFromFamilies(*entity);
+		}
+	}
 
 	notifying = true;
 
 	for (EntityListener *listener : listeners) {
-		listener->entityRemoved(*entity);
+		listener->entitiesRemoved(detached);
 	}
 
 	notifying = false;
 
 	removePendingListeners();
 
-	entities.erase(it);
+	for (auto entity : detached) {
+		eraseEntity(entity);
+	}
+}
+
+void ashley::Engine::detachEntity(Entity &entity) {
+	entity.engine = nullptr;
+	entity.operationHandler = nullptr;
+
+	removeFromFamilies(entity);
+}
+
+void ashley::Engine::removeFromFamilies(Entity &entity) {
+	// the entity can only belong to families mentioning its components, or a component whose removal is still
+	// waiting on a deferred family update, or to families which mention no components at all
+	auto candidates = entity.componentBits;
+
+	if (entity.dirtyIndex != 0u) {
+		candidates |= dirtyEntities[entity.dirtyIndex - 1].changedComponents;
+
+		// the dirty entry is skipped once the handle is released, so it mustn't follow the entity elsewhere
+		entity.dirtyIndex = 0u;
+	}
+
+	collectAffectedFamilies(candidates, true);
+
+	const auto slot = entity.handle.index;
+
+	for (auto members : affectedFamilies) {
+		if (members->contains(slot)) {
+			members->remove(slot);
+		}
+	}
 }
 
-void ashley::Engine::EngineOperationHandler::add(ashley::Entity * const entity, std::unique_ptr<Component> &&component,
-        const std::type_index typeIndex) {
+void ashley::Engine::eraseEntity(Entity *entity) {
+	releaseHandle(entity->handle);
+
+	// listeners could have added or removed other entities, so only look up the entity's position now
+	const auto index = entity->engineIndex;
+
+	if (index != entities.size() - 1) {
+		std::swap(entities[index], entities.back());
+		entities[index]->engineIndex = index;
+	}
+
+	entities.pop_back();
+	componentMasks.swapAndPop(index);
+
+	destroyEntity(entity);
+}
+
+void ashley::Engine::destroyEntity(Entity *entity) {
+	if (entity->pooled) {
+		entityPool.free(entity);
+	} else {
+		delete entity;
+	}
+}
+
+ashley::EntityHandle ashley::Engine::allocateHandle(Entity *entity) {
+	if (freeEntitySlots.empty()) {
+		assert(entitySlots.size() < UINT32_MAX && "too many entities");
+
+		entitySlots.push_back(EntitySlot { entity, 1u });
+		return EntityHandle(static_cast<uint32_t>(entitySlots.size() - 1), 1u);
+	}
+
+	const auto index = freeEntitySlots.back();
+	freeEntitySlots.pop_back();
+
+	auto &slot = entitySlots[index];
+	slot.entity = entity;
+
+	return EntityHandle(index, slot.generation);
+}
+
+void ashley::Engine::releaseHandle(EntityHandle handle) {
+	auto &slot = entitySlots[handle.index];
+
+	slot.entity = nullptr;
+
+	// generation 0 is reserved for null handles
+	if (++slot.generation == 0u) {
+		slot.generation = 1u;
+	}
+
+	freeEntitySlots.push_back(handle.index);
+}
+
+void ashley::Engine::EngineOperationHandler::add(ashley::Entity * const entity, ComponentPtr &&component,
+        uint64_t componentIndex) {
 	if (engine->updating) {
-		auto operation = engine->operationPool.obtain();
-		operation->makeAdd(entity, std::move(component), typeIndex);
-		engine->operationVector.push_back(operation);
+		std::unique_lock<std::mutex> lock;
+		engine->getCommandBuffer(lock).operations.push_back(
+		        ComponentOperation::makeAdd(entity->getHandle(), std::move(component), componentIndex));
 	} else {
-		entity->addInternal(std::move(component), typeIndex);
+		entity->addInternal(std::move(component), componentIndex);
 	}
 }
 
-void ashley::Engine::EngineOperationHandler::remove(ashley::Entity * const entity, std::type_index typeIndex) {
+void ashley::Engine::EngineOperationHandler::remove(ashley::Entity * const entity, uint64_t componentIndex) {
 	if (engine->updating) {
-		auto operation = engine->operationPool.obtain();
-		operation->makeRemove(entity, typeIndex);
-		engine->operationVector.push_back(operation);
+		std::unique_lock<std::mutex> lock;
+		engine->getCommandBuffer(lock).operations.push_back(
+		        ComponentOperation::makeRemove(entity->getHandle(), componentIndex));
+	} else {
+		entity->removeInternal(componentIndex);
+	}
+}
+
+void ashley::Engine::EngineOperationHandler::removeAll(ashley::Entity * const entity) {
+	if (engine->updating) {
+		std::unique_lock<std::mutex> lock;
+		auto &operations = engine->getCommandBuffer(lock).operations;
+		const auto &bits = entity->getComponentBits();
+
+		for (auto i = bits.nextSetBit(0); i != BitsType::npos; i = bits.nextSetBit(i + 1)) {
+			operations.push_back(ComponentOperation::makeRemove(entity->getHandle(), i));
+		}
 	} else {
-		entity->removeInternal(typeIndex);
+		entity->removeAllInternal();
 	}
 }
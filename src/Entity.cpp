@@ -28,71 +28,160 @@
 #include "Ashley/signals/Signal.hpp"
 #include "Ashley/core/Component.hpp"
 #include "Ashley/core/ComponentType.hpp"
-
-uint64_t ashley::Entity::nextIndex = 0;
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/internal/ArchetypeStorage.hpp"
 
 ashley::Entity::Entity() :
-		        index(nextIndex++) {
+		        handle() {
+}
+
+ashley::Entity::~Entity() {
+	if (storage != nullptr) {
+		storage->erase(*this);
+	}
+}
+
+void ashley::Entity::reset() {
+	if (storage != nullptr) {
+		storage->erase(*this);
+	}
+
+	// clearing rather than replacing keeps the storage for the entity's next use
+	components.clear();
+	componentBits.reset();
+
+	componentAdded.removeAll();
+	componentRemoved.removeAll();
+
+	flags = 0;
+	handle = EntityHandle();
+	operationHandler = nullptr;
+	operationHandlerTemp = nullptr;
+	engine = nullptr;
+	engineIndex = 0u;
+	dirtyIndex = 0u;
 }
 
-std::unique_ptr<ashley::Component> ashley::Entity::remove(const std::type_index typeIndex) {
-	return removeImpl(typeIndex);
+ashley::ComponentPtr ashley::Entity::remove(const std::type_index typeIndex) {
+	return removeImpl(ashley::ComponentType::getIndexFor(typeIndex));
 }
 
 void ashley::Entity::removeAll() {
+	if (operationHandler != nullptr) {
+		operationHandler->removeAll(this);
+	} else {
+		removeAllInternal();
+	}
+}
+
+void ashley::Entity::removeAllInternal() {
+	if (componentBits.none()) {
+		return;
+	}
+
+	if (storage != nullptr) {
+		storage->removeAll(*this);
+	}
+
+	const auto removedBits = componentBits;
+
 	componentBits.reset();
-	familyBits.reset();
+	components.clear();
 
-	componentMap.clear();
+	if (engine != nullptr) {
+		engine->componentsChanged(*this, removedBits);
+	}
+
+	componentRemoved.dispatch(this);
 }
 
 std::vector<ashley::Component *> ashley::Entity::getComponents() const {
 	std::vector<ashley::Component *> retVal;
 
-	for (auto &p : componentMap) {
-		retVal.emplace_back(p.second.get());
+	if (archetype != nullptr) {
+		for (auto i = componentBits.nextSetBit(0); i != BitsType::npos; i = componentBits.nextSetBit(i + 1)) {
+			retVal.emplace_back(static_cast<Component *>(archetype->getComponent(archetypeRow, i)));
+		}
+
+		return retVal;
+	}
+
+	for (auto &component : components) {
+		retVal.emplace_back(component.get());
 	}
 
 	return retVal;
 }
 
+void ashley::Entity::markChanged(uint64_t componentIndex) {
+	if (engine != nullptr && componentBits[componentIndex]) {
+		engine->changeTicks.mark(componentIndex, handle.index, engine->changeTick);
+	}
+}
+
+uint64_t ashley::Entity::getChangeTick(uint64_t componentIndex) const {
+	if (engine == nullptr || !componentBits[componentIndex]) {
+		return 0u;
+	}
+
+	return engine->changeTicks.get(componentIndex, handle.index);
+}
+
 const ashley::BitsType &ashley::Entity::getComponentBits() const {
 	return componentBits;
 }
 
-void ashley::Entity::addInternal(std::unique_ptr<Component> &&component, std::type_index type) {
-	auto typeID = ashley::ComponentType::getIndexFor(type);
-
-	if (componentBits[typeID]) {
-		componentMap[type] = nullptr;
+void ashley::Entity::addInternal(ComponentPtr &&component, uint64_t typeID) {
+	if (storage != nullptr) {
+		storage->add(*this, std::move(component), typeID);
+	} else {
+		const auto slot = getComponentSlot(typeID);
+
+		if (componentBits[typeID]) {
+			components[slot] = nullptr;
+			components[slot] = std::move(component);
+		} else {
+			components.emplace(components.begin() + slot, std::move(component));
+		}
 	}
 
-	componentBits[typeID] = true;
-	componentMap[type] = std::move(component);
+	componentBits.set(typeID);
+
+	if (engine != nullptr) {
+		engine->componentChanged(*this, typeID);
+	}
 
 	componentAdded.dispatch(this);
 }
 
-std::unique_ptr<ashley::Component> ashley::Entity::removeImpl(std::type_index typeIndex) {
+ashley::ComponentPtr ashley::Entity::removeImpl(uint64_t componentIndex) {
 	if (operationHandler != nullptr) {
-		operationHandler->remove(this, typeIndex);
+		operationHandler->remove(this, componentIndex);
 	} else {
-		return removeInternal(typeIndex);
+		return removeInternal(componentIndex);
 	}
 
-	return std::unique_ptr<Component> { nullptr };
+	return ComponentPtr { nullptr };
 }
 
-std::unique_ptr<ashley::Component> ashley::Entity::removeInternal(std::type_index typeIndex) {
-	const auto id = ashley::ComponentType::getIndexFor(typeIndex);
-	assert(id < componentBits.size() && "invalid component index; you might have too many component types");
-
-	std::unique_ptr<ashley::Component> ret { nullptr };
+ashley::ComponentPtr ashley::Entity::removeInternal(uint64_t id) {
+	ashley::ComponentPtr ret { nullptr };
 
 	if (componentBits[id] == true) {
-		componentBits[id] = false;
-		ret = std::move(componentMap.at(typeIndex));
-		componentMap.erase(typeIndex);
+		if (storage != nullptr) {
+			ret = storage->remove(*this, id);
+		} else {
+			const auto slot = getComponentSlot(id);
+
+			ret = std::move(components[slot]);
+			components.erase(components.begin() + slot);
+		}
+
+		componentBits.reset(id);
+
+		if (engine != nullptr) {
+			engine->componentChanged(*this, id);
+		}
 
 		componentRemoved.dispatch(this);
 	}
@@ -1,47 +1,94 @@
-#include <sstream>
+#include <algorithm>
+#include <mutex>
 
 #include "Ashley/core/Family.hpp"
 #include "Ashley/core/ComponentType.hpp"
 #include "Ashley/core/Entity.hpp"
 
 uint64_t ashley::Family::familyIndex = 0;
-std::unordered_map<ashley::Family::FamilyHashType, ashley::Family::internal_family_ptr> ashley::Family::families;
+std::unordered_multimap<std::size_t, ashley::Family::internal_family_ptr> ashley::Family::families;
 ashley::Family::use_getFor_not_constructor ashley::Family::constructorHider_;
 
+namespace {
+// guards families, since systems can look up families from several threads at once
+std::mutex registryMutex;
+}
+
 ashley::Family *ashley::Family::getFor(std::initializer_list<std::type_index> list) {
 	ashley::BitsType bits = ashley::ComponentType::getBitsFor(list);
 
 	return getFor(bits, ashley::BitsType(), ashley::BitsType());
 }
 
-ashley::Family *ashley::Family::getFor(ashley::BitsType all, ashley::BitsType one, ashley::BitsType exclude) {
-	const auto hash = ashley::Family::getFamilyHash(all, one, exclude);
+ashley::Family *ashley::Family::getFor(const ashley::BitsType &all, const ashley::BitsType &one,
+        const ashley::BitsType &exclude) {
+	const auto hash = hashBits(all, one, exclude);
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	const auto range = families.equal_range(hash);
+
+	for (auto it = range.first; it != range.second; ++it) {
+		const auto &family = *it->second;
 
-	const auto it = families.find(hash);
-	if (it == families.end()) {
-		families[hash] = std::unique_ptr<ashley::Family>(new Family(constructorHider_, all, one, exclude));
+		if (family.all == all && family.one == one && family.exclude == exclude) {
+			return it->second.get();
+		}
 	}
 
-	return families[hash].get();
+	return families.emplace(hash, internal_family_ptr(new Family(constructorHider_, all, one, exclude)))->second.get();
 }
 
 bool ashley::Family::matches(Entity &e) const {
-	auto entityComponentBits = e.getComponentBits();
+	return matches(e.getComponentBits());
+}
+
+bool ashley::Family::matches(const ashley::BitsType &entityComponentBits) const {
+	// one pass over the words, rather than one each for none, containsAll and the two intersects
+	const auto words = entityComponentBits.getWords();
+	const std::size_t wordCount = entityComponentBits.getWordCount();
+	const auto common = std::min(wordCount, requirements.size());
+
+	uint64_t present = 0u, missing = 0u, hit = 0u, excluded = 0u;
+
+	for (std::size_t i = 0u; i < common; ++i) {
+		const auto mask = words[i];
+		const auto &requirement = requirements[i];
 
-	if (entityComponentBits.none()) {
-		return false;
+		present |= mask;
+		missing |= requirement.all & ~mask;
+		hit |= requirement.one & mask;
+		excluded |= requirement.exclude & mask;
 	}
 
-	return !((all & entityComponentBits) != all || (one.any() && (one & entityComponentBits).none())
-			 || (exclude.any() && (exclude & entityComponentBits).any()));
+	for (std::size_t i = common; i < requirements.size(); ++i) {
+		missing |= requirements[i].all;
+	}
+
+	for (std::size_t i = common; i < wordCount; ++i) {
+		present |= words[i];
+	}
 
+	return present != 0u && missing == 0u && excluded == 0u && (!needsOne || hit != 0u);
 }
 
-ashley::Family::FamilyHashType ashley::Family::getFamilyHash(ashley::BitsType all, ashley::BitsType one,
-															 ashley::BitsType exclude) {
-	std::stringstream ss;
+void ashley::Family::buildRequirements() {
+	const auto getWord = [](const BitsType &bits, std::size_t word) {
+		return word < bits.getWordCount() ? bits.getWords()[word] : uint64_t(0u);
+	};
+
+	const std::size_t wordCount = std::max(all.getWordCount(), std::max(one.getWordCount(), exclude.getWordCount()));
 
-	ss << "all:" << all << ",one:" << one << ",exclude:" << exclude;
+	for (std::size_t i = 0u; i < wordCount; ++i) {
+		requirements.push_back(WordRequirement { getWord(all, i), getWord(one, i), getWord(exclude, i) });
+	}
+
+	while (!requirements.empty()) {
+		const auto &last = requirements.back();
 
-	return ss.str();
+		if ((last.all | last.one | last.exclude) != 0u) {
+			break;
+		}
+
+		requirements.pop_back();
+	}
 }
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Ashley/internal/FamilyMembers.hpp"
+#include "Ashley/core/Entity.hpp"
+
+ashley::internal::FamilyMembers::FamilyMembers(const Family &family, std::size_t id) :
+		        family(family),
+		        id(id) {
+}
+
+void ashley::internal::FamilyMembers::add(Entity &entity, uint32_t slot) {
+	assert(!contains(slot) && "entity is already a member of this family");
+
+	entities.push_back(&entity);
+	getPosition(slot) = static_cast<uint32_t>(entities.size());
+}
+
+void ashley::internal::FamilyMembers::remove(uint32_t slot) {
+	assert(contains(slot) && "entity is not a member of this family");
+
+	auto &position = getPosition(slot);
+	const auto index = position - 1;
+
+	auto last = entities.back();
+	entities[index] = last;
+	getPosition(last->getHandle().index) = index + 1;
+
+	entities.pop_back();
+	position = 0u;
+}
+
+void ashley::internal::FamilyMembers::clear() {
+	// zeroing whole pages avoids touching every member, and keeps the pages for reuse
+	for (auto &page : pages) {
+		if (page != nullptr) {
+			std::fill(page.get(), page.get() + pageMask + 1, 0u);
+		}
+	}
+
+	entities.clear();
+}
+
+uint32_t &ashley::internal::FamilyMembers::getPosition(uint32_t slot) {
+	const auto page = slot >> pageShift;
+
+	if (page >= pages.size()) {
+		pages.resize(page + 1);
+	}
+
+	if (pages[page] == nullptr) {
+		pages[page] = std::unique_ptr<uint32_t[]>(new uint32_t[pageMask + 1]());
+	}
+
+	return pages[page][slot & pageMask];
+}
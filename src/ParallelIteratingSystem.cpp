@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+
+#include <vector>
+
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/internal/CommandBuffer.hpp"
+#include "Ashley/systems/ParallelIteratingSystem.hpp"
+#include "Ashley/util/ThreadPool.hpp"
+
+void ashley::ParallelIteratingSystem::update(float deltaTime) {
+	const auto engine = getEngine();
+	const auto threadPool = engine != nullptr ? engine->getThreadPool() : nullptr;
+
+	// only safe while the engine is deferring structural changes
+	if (threadPool == nullptr || !engine->isUpdating() || entities->size() <= chunkSize) {
+		IteratingSystem::update(deltaTime);
+		return;
+	}
+
+	auto &members = *entities;
+	const auto systemBuffer = internal::CommandBuffer::getCurrent(engine);
+
+	// without a buffer of our own to merge into, changes go through the engine's shared buffer instead, in whatever
+	// order the chunks happen to run
+	if (systemBuffer == nullptr) {
+		threadPool->parallelFor(members.size(), chunkSize, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; ++i) {
+				processEntity(members[i], deltaTime);
+			}
+		});
+
+		return;
+	}
+
+	const auto size = chunkSize > 0u ? chunkSize : 1u;
+	const auto chunkCount = (members.size() + size - 1) / size;
+
+	if (chunkBuffers.size() < chunkCount) {
+		chunkBuffers.resize(chunkCount);
+	}
+
+	threadPool->parallelFor(members.size(), size, [&](std::size_t begin, std::size_t end) {
+		internal::CommandBuffer::Scope scope(chunkBuffers[begin / size], engine);
+
+		for (auto i = begin; i < end; ++i) {
+			processEntity(members[i], deltaTime);
+		}
+	});
+
+	for (std::size_t i = 0u; i < chunkCount; ++i) {
+		systemBuffer->append(chunkBuffers[i]);
+	}
+}
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+#include "Ashley/core/Prefab.hpp"
+
+void ashley::Prefab::addPrototype(uint64_t componentIndex, ComponentPtr &&component, Clone clone) {
+	const auto slot = componentBits.countBelow(componentIndex);
+
+	if (componentBits[componentIndex]) {
+		prototypes[slot].component = std::move(component);
+	} else {
+		prototypes.insert(prototypes.begin() + slot, Prototype { componentIndex, std::move(component), clone });
+		componentBits.set(componentIndex);
+	}
+}
+
+ashley::Component *ashley::Prefab::getPrototype(uint64_t componentIndex) const {
+	if (!componentBits[componentIndex]) {
+		return nullptr;
+	}
+
+	return prototypes[componentBits.countBelow(componentIndex)].component.get();
+}
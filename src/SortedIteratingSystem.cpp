@@ -33,6 +33,27 @@ void SortedIteratingSystem::entityRemoved(Entity &entity) {
 	sortedEntities.erase(std::remove(sortedEntities.begin(), sortedEntities.end(), &entity), sortedEntities.end());
 }
 
+void SortedIteratingSystem::entitiesAdded(const std::vector<Entity *> &entities) {
+	sortedEntities.insert(sortedEntities.end(), entities.begin(), entities.end());
+	shouldSort = true;
+}
+
+void SortedIteratingSystem::entitiesRemoved(const std::vector<Entity *> &entities) {
+	if (entities.size() == 1u) {
+		entityRemoved(*entities.front());
+		return;
+	}
+
+	removing.assign(entities.begin(), entities.end());
+	std::sort(removing.begin(), removing.end(), std::less<Entity *>());
+
+	sortedEntities.erase(std::remove_if(sortedEntities.begin(), sortedEntities.end(), [&](Entity *entity) {
+		return std::binary_search(removing.begin(), removing.end(), entity, std::less<Entity *>());
+	}), sortedEntities.end());
+
+	removing.clear();
+}
+
 void SortedIteratingSystem::update(float deltaTime) {
 	sort();
 	std::for_each(sortedEntities.begin(), sortedEntities.end(),
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Ashley/internal/SystemScheduler.hpp"
+#include "Ashley/core/EntitySystem.hpp"
+#include "Ashley/internal/CommandBuffer.hpp"
+#include "Ashley/util/ThreadPool.hpp"
+
+ashley::internal::SystemScheduler::SystemScheduler(ThreadPool &threadPool) :
+		        threadPool(threadPool),
+		        pending(nullptr),
+		        pendingCapacity(0u),
+		        remaining(0u),
+		        buffers(nullptr),
+		        deltaTime(0.0f) {
+}
+
+void ashley::internal::SystemScheduler::update(const std::vector<std::unique_ptr<EntitySystem>> &systems,
+        std::vector<CommandBuffer> &buffers, float deltaTime) {
+	if (systems.empty()) {
+		return;
+	}
+
+	buildGraph(systems);
+
+	this->buffers = buffers.data();
+	this->deltaTime = deltaTime;
+	remaining = nodes.size();
+
+	for (std::size_t i = 0u; i < nodes.size(); ++i) {
+		pending[i] = nodes[i].predecessorCount;
+	}
+
+	for (std::size_t i = 0u; i < nodes.size(); ++i) {
+		if (nodes[i].predecessorCount == 0u) {
+			threadPool.submit([this, i]() {runNode(i);});
+		}
+	}
+
+	threadPool.waitFor(remaining);
+}
+
+void ashley::internal::SystemScheduler::buildGraph(const std::vector<std::unique_ptr<EntitySystem>> &systems) {
+	const auto count = systems.size();
+
+	nodes.resize(count);
+
+	if (pendingCapacity < count) {
+		pending = std::unique_ptr<std::atomic<std::size_t>[]>(new std::atomic<std::size_t>[count]);
+		pendingCapacity = count;
+	}
+
+	for (std::size_t i = 0u; i < count; ++i) {
+		auto &node = nodes[i];
+		node.system = systems[i].get();
+		node.predecessorCount = 0u;
+		node.successors.clear();
+
+		// every earlier conflicting system gets an edge, so the order of conflicting systems never depends on timing
+		for (std::size_t j = 0u; j < i; ++j) {
+			if (nodes[j].system->conflictsWith(*node.system)) {
+				nodes[j].successors.push_back(i);
+				++node.predecessorCount;
+			}
+		}
+	}
+}
+
+void ashley::internal::SystemScheduler::runNode(std::size_t index) {
+	auto &node = nodes[index];
+
+	if (node.system->checkProcessing()) {
+		CommandBuffer::Scope scope(buffers[index], node.system->getEngine());
+		node.system->update(deltaTime);
+	}
+
+	for (auto successor : node.successors) {
+		if (pending[successor].fetch_sub(1u) == 1u) {
+			threadPool.submit([this, successor]() {runNode(successor);});
+		}
+	}
+
+	--remaining;
+}
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Ashley/util/ThreadPool.hpp"
+
+namespace {
+// identifies the pool and queue owned by the current thread, if it's a worker
+thread_local const ashley::ThreadPool *currentPool = nullptr;
+thread_local std::size_t currentQueue = 0u;
+}
+
+ashley::ThreadPool::ThreadPool(std::size_t threadCount) :
+		        queuedCount(0u),
+		        running(true) {
+	for (std::size_t i = 0u; i < threadCount + 1; ++i) {
+		queues.emplace_back(new TaskQueue());
+	}
+
+	threads.reserve(threadCount);
+
+	for (std::size_t i = 0u; i < threadCount; ++i) {
+		threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ashley::ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+
+	wakeUp.notify_all();
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void ashley::ThreadPool::submit(Task &&task) {
+	auto &queue = *queues[getQueueIndex()];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.emplace_back(std::move(task));
+	}
+
+	++queuedCount;
+
+	// taking the lock means a worker can't miss the wake up between checking queuedCount and going to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+
+	wakeUp.notify_one();
+	taskFinished.notify_all();
+}
+
+void ashley::ThreadPool::waitFor(const std::atomic<std::size_t> &remaining) {
+	const auto queueIndex = getQueueIndex();
+
+	while (remaining.load() != 0u) {
+		if (runTask(queueIndex)) {
+			continue;
+		}
+
+		// the work being waited for is running on other threads; sleep until some of it finishes or more is queued
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		taskFinished.wait(lock, [&]() {return remaining.load() == 0u || queuedCount.load() != 0u;});
+	}
+}
+
+void ashley::ThreadPool::parallelFor(std::size_t count, std::size_t chunkSize,
+        const std::function<void(std::size_t begin, std::size_t end)> &body) {
+	if (chunkSize == 0u) {
+		chunkSize = 1u;
+	}
+
+	const auto chunkCount = (count + chunkSize - 1) / chunkSize;
+
+	// each participant claims the next unprocessed chunk until none are left, so uneven chunks balance themselves
+	std::atomic<std::size_t> nextChunk(0u);
+
+	const auto processChunks = [&]() {
+		for (auto chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+			const auto begin = chunk * chunkSize;
+			body(begin, std::min(begin + chunkSize, count));
+		}
+	};
+
+	const auto helperCount = std::min(threads.size(), chunkCount > 0u ? chunkCount - 1 : 0u);
+
+	// helpers reference this stack frame, so wait for every helper rather than for every chunk
+	std::atomic<std::size_t> remainingHelpers(helperCount);
+
+	for (std::size_t i = 0u; i < helperCount; ++i) {
+		submit([&]() {
+			processChunks();
+			--remainingHelpers;
+		});
+	}
+
+	processChunks();
+	waitFor(remainingHelpers);
+}
+
+std::size_t ashley::ThreadPool::getDefaultThreadCount() {
+	const auto hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1u ? hardwareThreads - 1u : 0u;
+}
+
+std::size_t ashley::ThreadPool::getQueueIndex() const {
+	return currentPool == this ? currentQueue : queues.size() - 1;
+}
+
+bool ashley::ThreadPool::runTask(std::size_t queueIndex) {
+	Task task;
+
+	{
+		auto &own = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+		}
+	}
+
+	for (std::size_t i = 1u; !task && i < queues.size(); ++i) {
+		auto &victim = *queues[(queueIndex + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+	}
+
+	if (!task) {
+		return false;
+	}
+
+	--queuedCount;
+	task();
+
+	// as in submit, taking the lock means a waiting thread can't miss the notification after checking its counter
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+
+	taskFinished.notify_all();
+
+	return true;
+}
+
+void ashley::ThreadPool::workerLoop(std::size_t queueIndex) {
+	currentPool = this;
+	currentQueue = queueIndex;
+
+	while (true) {
+		if (runTask(queueIndex)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this]() {return !running || queuedCount.load() != 0u;});
+
+		if (!running) {
+			return;
+		}
+	}
+}
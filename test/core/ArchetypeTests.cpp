@@ -0,0 +1,223 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ashley/core/Archetype.hpp"
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/Family.hpp"
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::Archetype;
+using ashley::Engine;
+using ashley::Entity;
+using ashley::Family;
+using ashley::test::PositionComponent;
+using ashley::test::VelocityComponent;
+
+namespace {
+class NameComponent : public ashley::Component {
+public:
+	static int64_t alive;
+
+	std::string name;
+
+	explicit NameComponent(std::string name = "") :
+			        name(std::move(name)) {
+		++alive;
+	}
+
+	NameComponent(const NameComponent &other) :
+			        name(other.name) {
+		++alive;
+	}
+
+	NameComponent(NameComponent &&other) :
+			        name(std::move(other.name)) {
+		++alive;
+	}
+
+	~NameComponent() {
+		--alive;
+	}
+};
+
+int64_t NameComponent::alive = 0;
+
+class ArchetypeTest : public ::testing::Test {
+protected:
+	Engine engine { Engine::StorageMode::ARCHETYPE };
+};
+}
+
+// Ensure that components keep their values as an entity moves between archetypes.
+TEST_F(ArchetypeTest, ComponentsSurviveMoves) {
+	auto e = engine.addEntity();
+	e->add<PositionComponent>(1, 2);
+	e->add<NameComponent>("first");
+	e->add<VelocityComponent>(3, 4);
+
+	ASSERT_EQ(1, e->getComponent<PositionComponent>()->x);
+	ASSERT_EQ(2, e->getComponent<PositionComponent>()->y);
+	ASSERT_EQ(3, e->getComponent<VelocityComponent>()->x);
+	ASSERT_EQ("first", e->getComponent<NameComponent>()->name);
+
+	e->remove<PositionComponent>();
+
+	ASSERT_FALSE(e->hasComponent<PositionComponent>());
+	ASSERT_EQ("first", e->getComponent<NameComponent>()->name);
+	ASSERT_EQ(4, e->getComponent<VelocityComponent>()->y);
+
+	e->add<NameComponent>("second");
+
+	ASSERT_EQ("second", e->getComponent<NameComponent>()->name);
+	ashley::test::assertValidComponentAndBitSize(*e, 2);
+}
+
+// Ensure entities added with existing components are moved into storage.
+TEST_F(ArchetypeTest, AddPopulatedEntity) {
+	auto entity = std::unique_ptr<Entity>(new Entity());
+	entity->add<PositionComponent>(7, 8).add<NameComponent>("moved");
+
+	auto e = engine.addEntity(std::move(entity));
+
+	auto archetypes = engine.getArchetypesFor(Family::getFor({typeid(PositionComponent), typeid(NameComponent)}));
+
+	ASSERT_EQ(1u, archetypes.size());
+	ASSERT_EQ(1u, archetypes[0]->size());
+	ASSERT_EQ(e, archetypes[0]->getEntities(0)[0]);
+	ASSERT_EQ(7, archetypes[0]->getComponents<PositionComponent>(0)[0].x);
+	ASSERT_EQ("moved", e->getComponent<NameComponent>()->name);
+}
+
+// Ensure that chunks hold contiguous component arrays and that removal keeps them dense.
+TEST_F(ArchetypeTest, ChunkIteration) {
+	const int64_t numEntities = 600;
+	std::vector<Entity *> added;
+
+	for (int64_t i = 0; i < numEntities; ++i) {
+		auto e = engine.addEntity();
+		e->add<PositionComponent>(i, i).add<VelocityComponent>(i, -i);
+		added.push_back(e);
+	}
+
+	for (int64_t i = 0; i < numEntities; i += 2) {
+		engine.removeEntity(added[i]);
+	}
+
+	auto family = Family::getFor({typeid(PositionComponent), typeid(VelocityComponent)});
+	auto archetypes = engine.getArchetypesFor(family);
+
+	ASSERT_EQ(1u, archetypes.size());
+
+	auto archetype = archetypes[0];
+
+	ASSERT_EQ(static_cast<size_t>(numEntities / 2), archetype->size());
+	ASSERT_GT(archetype->getChunkCount(), 1u);
+	ASSERT_EQ(0u, archetype->getChunkCapacity() & (archetype->getChunkCapacity() - 1));
+
+	size_t seen = 0u;
+
+	for (size_t chunk = 0u; chunk < archetype->getChunkCount(); ++chunk) {
+		auto entities = archetype->getEntities(chunk);
+		auto positions = archetype->getComponents<PositionComponent>(chunk);
+		auto velocities = archetype->getComponents<VelocityComponent>(chunk);
+
+		ASSERT_TRUE(archetype->getComponents<NameComponent>(chunk) == nullptr);
+
+		for (size_t i = 0u; i < archetype->getChunkSize(chunk); ++i) {
+			ASSERT_EQ(1, positions[i].x % 2);
+			ASSERT_EQ(positions[i].x, -velocities[i].y);
+			ASSERT_EQ(&positions[i], entities[i]->getComponent<PositionComponent>());
+			++seen;
+		}
+	}
+
+	ASSERT_EQ(archetype->size(), seen);
+	ASSERT_EQ(seen, engine.getEntitiesFor(family)->size());
+}
+
+// Ensure that family membership follows archetype moves.
+TEST_F(ArchetypeTest, FamilyMembership) {
+	auto entities = engine.getEntitiesFor(Family::getFor({typeid(PositionComponent)}));
+
+	auto e1 = engine.addEntity();
+	auto e2 = engine.addEntity();
+
+	e1->add<PositionComponent>();
+	e2->add<VelocityComponent>();
+
+	ASSERT_EQ(1u, entities->size());
+
+	e2->add<PositionComponent>();
+	e1->remove<PositionComponent>();
+
+	ASSERT_EQ(1u, entities->size());
+	ASSERT_EQ(e2, entities->at(0));
+	ashley::test::assertValidComponentAndBitSize(*e1, 0);
+}
+
+// Ensure that every stored component is destroyed exactly once.
+TEST(ArchetypeLifetimeTest, ComponentsDestroyed) {
+	{
+		Engine engine(Engine::StorageMode::ARCHETYPE);
+
+		for (int i = 0; i < 100; ++i) {
+			auto e = engine.addEntity();
+			e->add<NameComponent>("name").add<PositionComponent>();
+
+			if (i % 3 == 0) {
+				e->remove<PositionComponent>();
+			}
+
+			if (i % 5 == 0) {
+				engine.removeEntity(e);
+			}
+		}
+
+		ASSERT_GT(NameComponent::alive, 0);
+	}
+
+	ASSERT_EQ(0, NameComponent::alive);
+}
+
+// Ensure that recycled entities leave their old archetype and start with no components.
+TEST_F(ArchetypeTest, RecycledEntitiesLeaveArchetypes) {
+	auto e = engine.addEntity();
+	e->add<PositionComponent>(1, 2).add<NameComponent>("recycled");
+
+	const auto aliveBefore = NameComponent::alive;
+	engine.removeEntity(e);
+
+	ASSERT_EQ(aliveBefore - 1, NameComponent::alive);
+
+	auto recycled = engine.addEntity();
+	ASSERT_EQ(e, recycled);
+	ASSERT_EQ(0u, recycled->countComponents());
+
+	recycled->add<PositionComponent>(3, 4);
+
+	auto archetypes = engine.getArchetypesFor(Family::getFor<PositionComponent>());
+	ASSERT_EQ(1u, archetypes.size());
+	ASSERT_EQ(1u, archetypes[0]->size());
+	ASSERT_EQ(3, recycled->getComponent<PositionComponent>()->x);
+}
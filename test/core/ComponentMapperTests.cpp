@@ -1,6 +1,7 @@
 #include "AshleyTestCommon.hpp"
 
 #include "Ashley/core/ComponentMapper.hpp"
+#include "Ashley/core/Engine.hpp"
 #include "Ashley/core/Entity.hpp"
 #include "Ashley/core/ComponentType.hpp"
 
@@ -47,3 +48,28 @@ TEST_F(ComponentMapperTest, ValidGetAndHas) {
 
 	ASSERT_FALSE(fooMapper.get(e.get()) == nullptr);
 }
+
+// Ensure that mappers resolve their index up front and work with archetype storage.
+TEST_F(ComponentMapperTest, ArchetypeStorage) {
+	ashley::Engine engine(ashley::Engine::StorageMode::ARCHETYPE);
+	auto fooMapper = ashley::ComponentMapper<FooComponent>::getFor(typeid(FooComponent));
+
+	ASSERT_EQ(ashley::ComponentType::getIndexFor<ashley::test::PositionComponent>(),
+	        positionMapper.getComponentIndex());
+
+	auto e = engine.addEntity();
+	e->add<ashley::test::VelocityComponent>(5, 6).add<ashley::test::PositionComponent>(10, 2);
+
+	ASSERT_TRUE(positionMapper.has(e));
+	ASSERT_FALSE(fooMapper.has(e));
+	ASSERT_EQ(10, positionMapper.get(e)->x);
+	ASSERT_EQ(6, velocityMapper.get(e)->y);
+	ASSERT_TRUE(fooMapper.get(e) == nullptr);
+
+	e->add<FooComponent>();
+	e->remove<ashley::test::VelocityComponent>();
+
+	ASSERT_TRUE(fooMapper.has(e));
+	ASSERT_FALSE(velocityMapper.has(e));
+	ASSERT_EQ(2, positionMapper.get(e)->y);
+}
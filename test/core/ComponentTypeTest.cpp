@@ -2,6 +2,8 @@
 #include <typeinfo>
 
 #include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/Family.hpp"
 #include "AshleyTestCommon.hpp"
 
 #include "gtest/gtest.h"
@@ -52,3 +54,46 @@ TEST(ComponentTypeTest, GetBitsFor) {
 	ASSERT_EQ(type1, type2);
 	ASSERT_EQ(type3, type4);
 }
+
+namespace {
+template<int N> class NumberedComponent : public ashley::Component {
+};
+
+template<int N> struct RegisterNumbered {
+	static void run() {
+		RegisterNumbered<N - 1>::run();
+		ashley::ComponentType::getFor<NumberedComponent<N>>();
+	}
+};
+
+template<> struct RegisterNumbered<0> {
+	static void run() {
+		ashley::ComponentType::getFor<NumberedComponent<0>>();
+	}
+};
+}
+
+// Ensure that there's no fixed limit on the number of component types.
+TEST(ComponentTypeTest, ManyComponentTypes) {
+	RegisterNumbered<299>::run();
+
+	const auto highIndex = ashley::ComponentType::getIndexFor<NumberedComponent<299>>();
+	ASSERT_GE(highIndex, 299u);
+
+	ashley::Engine engine;
+	auto family = engine.getEntitiesFor(
+	        ashley::Family::getFor<NumberedComponent<299>, ashley::test::PositionComponent>());
+
+	auto e = engine.addEntity();
+	e->add<NumberedComponent<299>>().add<ashley::test::PositionComponent>(1, 2).add<NumberedComponent<150>>();
+
+	ASSERT_EQ(1u, family->size());
+	ASSERT_TRUE(e->getComponentBits()[highIndex]);
+	ASSERT_EQ(2, e->getComponent<ashley::test::PositionComponent>()->y);
+	ashley::test::assertValidComponentAndBitSize(*e, 3);
+
+	e->remove<NumberedComponent<299>>();
+
+	ASSERT_EQ(0u, family->size());
+	ASSERT_FALSE(e->getComponentBits()[highIndex]);
+}
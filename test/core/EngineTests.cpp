@@ -5,6 +5,8 @@
 #include <functional>
 #include <typeindex>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "Ashley/core/Engine.hpp"
 
@@ -14,6 +16,7 @@ using ashley::Engine;
 using ashley::Entity;
 using ashley::EntityListener;
 using ashley::EntitySystem;
+using ashley::BitsType;
 using ashley::Component;
 using ashley::ComponentType;
 using ashley::Family;
@@ -28,6 +31,22 @@ class ComponentB : public Component {
 class ComponentC : public Component {
 };
 
+template<int N> class NumberedComponent : public Component {
+};
+
+template<int N> struct RegisterNumbered {
+	static void run() {
+		RegisterNumbered<N - 1>::run();
+		ComponentType::getFor<NumberedComponent<N>>();
+	}
+};
+
+template<> struct RegisterNumbered<0> {
+	static void run() {
+		ComponentType::getFor<NumberedComponent<0>>();
+	}
+};
+
 class EntityListenerMock final : public EntityListener {
 public:
 	uint64_t addedCount = 0;
@@ -94,6 +113,100 @@ public:
 	}
 };
 
+class ComponentMutatorSystem final : public EntitySystem {
+public:
+	Entity *entity = nullptr;
+	bool appliedDuringUpdate = false;
+
+	ComponentMutatorSystem() :
+			EntitySystem(0) {
+	}
+
+	void update(float deltaTime) override {
+		entity->add<ComponentB>();
+		entity->remove<ComponentA>();
+
+		appliedDuringUpdate = entity->hasComponent<ComponentB>() || !entity->hasComponent<ComponentA>();
+	}
+};
+
+template<int P> class SpawningSystem final : public EntitySystem {
+public:
+	Entity *spawned = nullptr;
+	bool validDuringUpdate = false;
+
+	SpawningSystem() :
+			EntitySystem(P) {
+		declareReads<ComponentA>();
+	}
+
+	void update(float deltaTime) override {
+		spawned = getEngine()->addEntity();
+		spawned->add<NumberedComponent<P>>();
+		validDuringUpdate = getEngine()->isValid(spawned->getHandle());
+	}
+};
+
+class OrderListener final : public EntityListener {
+public:
+	std::vector<Entity *> added;
+
+	void entityAdded(Entity &entity) override {
+		added.push_back(&entity);
+	}
+
+	void entityRemoved(Entity &entity) override {
+	}
+};
+
+class BatchListener final : public EntityListener {
+public:
+	uint64_t batches = 0;
+	uint64_t addedCount = 0;
+	uint64_t removedBatches = 0;
+	uint64_t removedCount = 0;
+
+	void entityAdded(Entity &entity) override {
+	}
+
+	void entityRemoved(Entity &entity) override {
+	}
+
+	void entitiesAdded(const std::vector<Entity *> &entities) override {
+		++batches;
+		addedCount += entities.size();
+	}
+
+	void entitiesRemoved(const std::vector<Entity *> &entities) override {
+		++removedBatches;
+		removedCount += entities.size();
+	}
+};
+
+class RemoveAllSystem final : public EntitySystem {
+public:
+	RemoveAllSystem() :
+			EntitySystem(0) {
+	}
+
+	void update(float deltaTime) override {
+		getEngine()->removeAllEntities();
+	}
+};
+
+class NestedUpdateSystem final : public EntitySystem {
+public:
+	Engine *inner = nullptr;
+
+	NestedUpdateSystem() :
+			EntitySystem(0) {
+	}
+
+	void update(float deltaTime) override {
+		inner->update(deltaTime);
+	}
+};
+
 class EngineTest : public ::testing::Test {
 protected:
 	const float deltaTime = 0.16f;
@@ -114,6 +227,18 @@ protected:
 }
 
 // Ensure that listeners work with adding and removing all entities.
+// Ensure that engines can be moved, as declared.
+TEST_F(EngineTest, MoveEngine) {
+	static_assert(std::is_move_constructible<Engine>::value, "engines must be move constructible");
+	static_assert(std::is_move_assignable<Engine>::value, "engines must be move assignable");
+
+	Engine moved(std::move(engine));
+	Engine assigned;
+	assigned = std::move(moved);
+
+	ASSERT_EQ(0u, assigned.getSystems().size());
+}
+
 TEST_F(EngineTest, AddAndRemoveEntities) {
 	engine.addEntity();
 
@@ -393,3 +518,523 @@ TEST_F(EngineTest, GetSystems) {
 
 	ASSERT_EQ(sys.size(), 2u);
 }
+
+// Ensure that family membership is still tracked for entities whose position in the engine changed.
+TEST_F(EngineTest, FamilyMembershipAfterRemoval) {
+	auto entities = engine.getEntitiesFor(Family::getFor({typeid(ComponentA)}));
+
+	auto e1 = engine.addEntity();
+	auto e2 = engine.addEntity();
+	auto e3 = engine.addEntity();
+
+	engine.removeEntity(e1);
+
+	e2->add<ComponentA>();
+	e3->add<ComponentA>();
+
+	ASSERT_EQ(2u, entities->size());
+
+	e3->remove<ComponentA>();
+
+	ASSERT_EQ(1u, entities->size());
+	ASSERT_EQ(e2, entities->at(0));
+}
+
+// Ensure that removing entities from the middle of the engine keeps every family consistent.
+TEST_F(EngineTest, RemoveEntitiesKeepsFamiliesConsistent) {
+	auto withA = engine.getEntitiesFor(Family::getFor({typeid(ComponentA)}));
+	auto withB = engine.getEntitiesFor(Family::getFor({typeid(ComponentB)}));
+
+	std::vector<Entity *> added;
+
+	for (int i = 0; i < 100; ++i) {
+		auto e = engine.addEntity();
+		e->add<ComponentA>();
+
+		if (i % 2 == 0) {
+			e->add<ComponentB>();
+		}
+
+		added.push_back(e);
+	}
+
+	for (int i = 0; i < 100; i += 3) {
+		engine.removeEntity(added[i]);
+	}
+
+	added[1]->removeAll();
+
+	ASSERT_EQ(100u - 34u - 1u, withA->size());
+	ASSERT_EQ(50u - 17u, withB->size());
+
+	for (int i = 0; i < 100; ++i) {
+		const bool expectA = (i % 3 != 0) && i != 1;
+		const bool expectB = (i % 3 != 0) && (i % 2 == 0);
+
+		ASSERT_EQ(expectA, std::find(withA->begin(), withA->end(), added[i]) != withA->end()) << "i = " << i;
+		ASSERT_EQ(expectB, std::find(withB->begin(), withB->end(), added[i]) != withB->end()) << "i = " << i;
+	}
+}
+
+// Ensure that handles resolve to their entity until it's removed, and that recycled slots don't revive old handles.
+TEST_F(EngineTest, EntityHandles) {
+	auto e1 = engine.addEntity();
+	auto e2 = engine.addEntity();
+
+	const auto h1 = e1->getHandle();
+	const auto h2 = e2->getHandle();
+
+	ASSERT_FALSE(h1.isNull());
+	ASSERT_NE(h1, h2);
+	ASSERT_EQ(e1, engine.getEntity(h1));
+	ASSERT_EQ(e2, engine.getEntity(h2));
+	ASSERT_TRUE(engine.getEntity(ashley::EntityHandle()) == nullptr);
+
+	engine.removeEntity(e1);
+
+	ASSERT_FALSE(engine.isValid(h1));
+	ASSERT_TRUE(engine.isValid(h2));
+
+	auto e3 = engine.addEntity();
+	const auto h3 = e3->getHandle();
+
+	ASSERT_EQ(h1.index, h3.index);
+	ASSERT_NE(h1.generation, h3.generation);
+	ASSERT_TRUE(engine.getEntity(h1) == nullptr);
+	ASSERT_EQ(e3, engine.getEntity(h3));
+}
+
+// Ensure that families which only exclude components are updated when unrelated components change.
+TEST_F(EngineTest, ExcludeOnlyFamilyMembership) {
+	auto withoutB = engine.getEntitiesFor(
+			Family::getFor(ashley::BitsType(), ashley::BitsType(), ComponentType::getBitsFor<ComponentB>()));
+	auto withC = engine.getEntitiesFor(Family::getFor({typeid(ComponentC)}));
+
+	auto e = engine.addEntity();
+
+	ASSERT_EQ(0u, withoutB->size());
+
+	e->add<ComponentA>();
+
+	ASSERT_EQ(1u, withoutB->size());
+	ASSERT_EQ(0u, withC->size());
+
+	e->add<ComponentB>();
+
+	ASSERT_EQ(0u, withoutB->size());
+
+	e->remove<ComponentB>();
+	e->add<ComponentC>();
+
+	ASSERT_EQ(1u, withoutB->size());
+	ASSERT_EQ(1u, withC->size());
+
+	e->removeAll();
+
+	ASSERT_EQ(0u, withoutB->size());
+	ASSERT_EQ(0u, withC->size());
+}
+
+// Ensure that deferred family updates are applied once at the sync point and skip removed entities.
+TEST_F(EngineTest, DeferredFamilyUpdates) {
+	auto familyAB = engine.getEntitiesFor(Family::getFor({typeid(ComponentA), typeid(ComponentB)}));
+	auto familyC = engine.getEntitiesFor(Family::getFor({typeid(ComponentC)}));
+
+	engine.setDeferFamilyUpdates(true);
+	ASSERT_TRUE(engine.getDeferFamilyUpdates());
+
+	auto e1 = engine.addEntity();
+	auto e2 = engine.addEntity();
+
+	e1->add<ComponentA>().add<ComponentB>();
+	e2->add<ComponentC>();
+
+	ASSERT_EQ(0u, familyAB->size());
+	ASSERT_EQ(0u, familyC->size());
+
+	engine.removeEntity(e2);
+	engine.updateFamilies();
+
+	ASSERT_EQ(1u, familyAB->size());
+	ASSERT_EQ(e1, familyAB->at(0));
+	ASSERT_EQ(0u, familyC->size());
+
+	e1->remove<ComponentB>();
+	e1->add<ComponentB>();
+	e1->add<ComponentC>();
+
+	engine.update(deltaTime);
+
+	ASSERT_EQ(1u, familyAB->size());
+	ASSERT_EQ(1u, familyC->size());
+
+	e1->removeAll();
+
+	ASSERT_EQ(1u, familyAB->size());
+
+	engine.setDeferFamilyUpdates(false);
+
+	ASSERT_EQ(0u, familyAB->size());
+	ASSERT_EQ(0u, familyC->size());
+}
+
+TEST_F(EngineTest, ManyFamilies) {
+	const auto numFamilies = 200u;
+	const auto allBits = ComponentType::getBitsFor<ComponentA>();
+
+	std::vector<std::vector<Entity *> *> families;
+
+	for (auto i = 0u; i < numFamilies; i++) {
+		// every family is distinct but matches the same entities, since nothing has the excluded components
+		BitsType exclude;
+		exclude.set(1000u + i);
+
+		families.push_back(engine.getEntitiesFor(Family::getFor(allBits, BitsType(), exclude)));
+	}
+
+	auto e1 = engine.addEntity();
+	auto e2 = engine.addEntity();
+	auto e3 = engine.addEntity();
+	auto e4 = engine.addEntity();
+
+	e1->add<ComponentA>();
+	e2->add<ComponentA>();
+	e3->add<ComponentA>().add<ComponentB>();
+	e4->add<ComponentB>();
+
+	for (auto family : families) {
+		ASSERT_EQ(3u, family->size());
+	}
+
+	engine.removeEntity(e2);
+	e3->remove<ComponentA>();
+
+	for (auto family : families) {
+		ASSERT_EQ(1u, family->size());
+		ASSERT_EQ(e1, family->at(0));
+	}
+
+	e3->add<ComponentA>();
+	engine.removeEntity(e1);
+
+	for (auto family : families) {
+		ASSERT_EQ(1u, family->size());
+		ASSERT_EQ(e3, family->at(0));
+	}
+}
+
+// Ensure that families registered after their entities match the same entities as Family::matches, including
+// entities with no components and components beyond the first 64 indices.
+TEST_F(EngineTest, NewFamiliesMatchExistingEntities) {
+	RegisterNumbered<129>::run();
+
+	using High = NumberedComponent<129>;
+	ASSERT_GE(ComponentType::getIndexFor<High>(), 128u);
+
+	std::vector<Entity *> added;
+
+	for (auto i = 0; i < 1000; i++) {
+		auto e = engine.addEntity();
+
+		if (i % 2 == 1) {
+			e->add<ComponentA>();
+		}
+
+		if (i % 3 == 0) {
+			e->add<ComponentB>();
+		}
+
+		if (i % 5 == 0) {
+			e->add<ComponentC>();
+		}
+
+		if (i % 7 == 0) {
+			e->add<High>();
+		}
+
+		added.push_back(e);
+	}
+
+	const auto checkFamily = [&](Family *family) {
+		auto members = engine.getEntitiesFor(family);
+		std::size_t expected = 0u;
+
+		for (auto e : added) {
+			if (family->matches(*e)) {
+				expected++;
+			}
+		}
+
+		ASSERT_EQ(expected, members->size());
+
+		for (auto e : *members) {
+			ASSERT_TRUE(family->matches(*e));
+		}
+	};
+
+	const BitsType none;
+
+	checkFamily(Family::getFor<ComponentA>());
+	checkFamily(Family::getFor<ComponentA, High>());
+	checkFamily(Family::getFor(none, ComponentType::getBitsFor<ComponentB, High>(), none));
+	checkFamily(Family::getFor(none, none, ComponentType::getBitsFor<ComponentC>()));
+	checkFamily(Family::getFor(ComponentType::getBitsFor<ComponentA>(), none, ComponentType::getBitsFor<High>()));
+	checkFamily(Family::getFor(none, ComponentType::getBitsFor<ComponentC>(), ComponentType::getBitsFor<ComponentB>()));
+
+	// moves entities around the engine's storage before registering more families
+	std::vector<Entity *> remaining;
+
+	for (std::size_t i = 0u; i < added.size(); i++) {
+		if (i % 4u == 0u) {
+			engine.removeEntity(added[i]);
+		} else {
+			if (i % 6u == 1u) {
+				added[i]->add<ComponentC>();
+			}
+
+			if (i % 7u == 0u) {
+				added[i]->remove<High>();
+			}
+
+			remaining.push_back(added[i]);
+		}
+	}
+
+	added = remaining;
+
+	checkFamily(Family::getFor<ComponentA, ComponentC>());
+	checkFamily(Family::getFor(ComponentType::getBitsFor<ComponentC>(), none, ComponentType::getBitsFor<ComponentA>()));
+	checkFamily(Family::getFor(none, ComponentType::getBitsFor<High>(), none));
+}
+
+// Ensure that entities created by the engine are reset before being reused.
+TEST_F(EngineTest, RecycledEntitiesAreReset) {
+	auto e = engine.addEntity();
+	e->add<ComponentA>().add<ComponentB>();
+	e->flags = 5u;
+
+	const auto oldHandle = e->getHandle();
+	auto family = engine.getEntitiesFor(Family::getFor<ComponentA>());
+
+	ASSERT_EQ(1u, family->size());
+
+	engine.removeEntity(e);
+
+	auto recycled = engine.addEntity();
+
+	ASSERT_EQ(e, recycled);
+	ASSERT_EQ(0u, recycled->flags);
+	ASSERT_EQ(0u, recycled->countComponents());
+	ASSERT_TRUE(recycled->getComponents().empty());
+	ASSERT_FALSE(engine.isValid(oldHandle));
+	ASSERT_TRUE(engine.isValid(recycled->getHandle()));
+	ASSERT_EQ(0u, family->size());
+
+	recycled->add<ComponentA>();
+
+	ASSERT_EQ(1u, family->size());
+	ASSERT_EQ(recycled, family->at(0));
+}
+
+
+// Ensure that component operations made during an update are deferred and then replayed in order.
+TEST_F(EngineTest, DeferredComponentOperations) {
+	auto e = engine.addEntity();
+	e->add<ComponentA>();
+
+	auto familyA = engine.getEntitiesFor(Family::getFor<ComponentA>());
+	auto familyB = engine.getEntitiesFor(Family::getFor<ComponentB>());
+
+	auto system = engine.addSystem<ComponentMutatorSystem>();
+	system->entity = e;
+
+	engine.update(deltaTime);
+
+	ASSERT_FALSE(system->appliedDuringUpdate);
+	ASSERT_FALSE(e->hasComponent<ComponentA>());
+	ASSERT_TRUE(e->hasComponent<ComponentB>());
+	ASSERT_EQ(0u, familyA->size());
+	ASSERT_EQ(1u, familyB->size());
+
+	// the buffer is reused by later updates, including for recycled entities
+	engine.removeEntity(e);
+	system->entity = engine.addEntity();
+	system->entity->add<ComponentA>();
+
+	engine.update(deltaTime);
+
+	ASSERT_TRUE(system->entity->hasComponent<ComponentB>());
+	ASSERT_EQ(1u, familyB->size());
+}
+
+// Ensure that entities added by systems running in parallel are added after the update, in system priority order.
+TEST_F(EngineTest, EntitiesAddedDuringUpdateInPriorityOrder) {
+	OrderListener order;
+	engine.addEntityListener(&order);
+	engine.setThreadCount(3);
+
+	auto first = engine.addSystem<SpawningSystem<1>>();
+	auto second = engine.addSystem<SpawningSystem<2>>();
+	auto third = engine.addSystem<SpawningSystem<3>>();
+
+	auto family = engine.getEntitiesFor(Family::getFor<NumberedComponent<2>>());
+
+	for (int i = 0; i < 20; ++i) {
+		order.added.clear();
+		engine.update(deltaTime);
+
+		ASSERT_FALSE(first->validDuringUpdate);
+		ASSERT_EQ(3u, order.added.size());
+		ASSERT_EQ(first->spawned, order.added[0]);
+		ASSERT_EQ(second->spawned, order.added[1]);
+		ASSERT_EQ(third->spawned, order.added[2]);
+		ASSERT_TRUE(engine.isValid(second->spawned->getHandle()));
+		ASSERT_EQ(static_cast<std::size_t>(i + 1), family->size());
+	}
+
+	engine.removeEntityListener(&order);
+}
+
+// Ensure that entities added in bulk join the right families and listeners are notified of every entity.
+TEST_F(EngineTest, AddEntitiesInBulk) {
+	BatchListener batchListener;
+	engine.addEntityListener(&batchListener);
+
+	auto familyA = engine.getEntitiesFor(Family::getFor<ComponentA>());
+	auto familyAB = engine.getEntitiesFor(Family::getFor<ComponentA, ComponentB>());
+	auto familyC = engine.getEntitiesFor(Family::getFor<ComponentC>());
+
+	std::vector<Entity *> added;
+
+	engine.addEntities<ComponentA>(100, [&](Entity &entity, std::size_t i) {
+		if (i % 4 < 2) {
+			entity.add<ComponentB>();
+		}
+
+		added.push_back(&entity);
+	});
+
+	ASSERT_EQ(100u, added.size());
+	ASSERT_EQ(100u, listenerA.addedCount);
+	ASSERT_EQ(100u, listenerB.addedCount);
+	ASSERT_EQ(1u, batchListener.batches);
+	ASSERT_EQ(100u, batchListener.addedCount);
+
+	ASSERT_EQ(100u, familyA->size());
+	ASSERT_EQ(50u, familyAB->size());
+	ASSERT_EQ(0u, familyC->size());
+
+	for (std::size_t i = 0u; i < added.size(); ++i) {
+		ASSERT_TRUE(engine.isValid(added[i]->getHandle()));
+		ASSERT_EQ(i % 4 < 2, added[i]->hasComponent<ComponentB>());
+	}
+
+	// entities added in bulk behave like any other once they're in the engine
+	added[0]->add<ComponentC>();
+	added[1]->remove<ComponentA>();
+
+	ASSERT_EQ(1u, familyC->size());
+	ASSERT_EQ(99u, familyA->size());
+	ASSERT_EQ(49u, familyAB->size());
+
+	engine.addEntities<ComponentB, ComponentC>(10);
+
+	ASSERT_EQ(2u, batchListener.batches);
+	ASSERT_EQ(11u, familyC->size());
+	ASSERT_EQ(110u, listenerA.addedCount);
+
+	engine.removeEntityListener(&batchListener);
+}
+
+// Ensure that removing entities in bulk notifies listeners once and leaves the engine consistent.
+TEST_F(EngineTest, RemoveEntitiesInBulk) {
+	BatchListener batchListener;
+	engine.addEntityListener(&batchListener);
+
+	auto familyA = engine.getEntitiesFor(Family::getFor<ComponentA>());
+	auto familyB = engine.getEntitiesFor(Family::getFor<ComponentB>());
+
+	std::vector<Entity *> added;
+
+	engine.addEntities<ComponentA>(100, [&](Entity &entity, std::size_t i) {
+		if (i % 2 == 0) {
+			entity.add<ComponentB>();
+		}
+
+		added.push_back(&entity);
+	});
+
+	const auto keptHandle = added[1]->getHandle();
+	const auto removedHandle = added[0]->getHandle();
+
+	engine.removeEntitiesFor(Family::getFor<ComponentB>());
+
+	ASSERT_EQ(1u, batchListener.removedBatches);
+	ASSERT_EQ(50u, batchListener.removedCount);
+	ASSERT_EQ(50u, listenerA.removedCount);
+	ASSERT_EQ(0u, familyB->size());
+	ASSERT_EQ(50u, familyA->size());
+	ASSERT_TRUE(engine.isValid(keptHandle));
+	ASSERT_FALSE(engine.isValid(removedHandle));
+
+	for (auto entity : *familyA) {
+		ASSERT_FALSE(entity->hasComponent<ComponentB>());
+	}
+
+	// entities listed twice or not in the engine are ignored
+	auto kept = engine.getEntity(keptHandle);
+	engine.removeEntities(std::vector<Entity *> { kept, kept });
+
+	ASSERT_EQ(2u, batchListener.removedBatches);
+	ASSERT_EQ(51u, batchListener.removedCount);
+	ASSERT_EQ(49u, familyA->size());
+
+	engine.removeAllEntities();
+
+	ASSERT_EQ(3u, batchListener.removedBatches);
+	ASSERT_EQ(100u, batchListener.removedCount);
+	ASSERT_EQ(100u, listenerB.removedCount);
+	ASSERT_EQ(0u, familyA->size());
+
+	engine.removeEntityListener(&batchListener);
+}
+
+// Ensure that removing all entities during an update is deferred until the systems have finished.
+TEST_F(EngineTest, RemoveAllEntitiesDuringUpdate) {
+	std::vector<Entity *> added;
+	engine.addEntities<ComponentA>(10, [&](Entity &entity, std::size_t) {added.push_back(&entity);});
+	const auto handle = added[0]->getHandle();
+
+	engine.addSystem<RemoveAllSystem>();
+
+	auto family = engine.getEntitiesFor(Family::getFor<ComponentA>());
+
+	engine.update(deltaTime);
+
+	ASSERT_EQ(10u, listenerA.removedCount);
+	ASSERT_EQ(0u, family->size());
+	ASSERT_FALSE(engine.isValid(handle));
+}
+
+// Ensure that changes to an engine's entities made while another engine is updating go to the engine they belong to.
+TEST_F(EngineTest, NestedEngineUpdate) {
+	Engine inner;
+
+	auto outerEntity = engine.addEntity();
+	outerEntity->add<ComponentA>();
+
+	auto innerEntity = inner.addEntity();
+	innerEntity->add<ComponentA>();
+
+	auto mutator = inner.addSystem<ComponentMutatorSystem>();
+	mutator->entity = outerEntity;
+
+	engine.addSystem<NestedUpdateSystem>()->inner = &inner;
+
+	engine.update(deltaTime);
+
+	ASSERT_FALSE(outerEntity->hasComponent<ComponentA>());
+	ASSERT_TRUE(outerEntity->hasComponent<ComponentB>());
+	ASSERT_TRUE(innerEntity->hasComponent<ComponentA>());
+	ASSERT_FALSE(innerEntity->hasComponent<ComponentB>());
+}
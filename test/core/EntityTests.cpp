@@ -5,7 +5,9 @@
 #include <typeinfo>
 #include <typeindex>
 #include <memory>
+#include <unordered_set>
 
+#include "Ashley/core/Engine.hpp"
 #include "Ashley/core/Entity.hpp"
 
 #include "AshleyTestCommon.hpp"
@@ -56,17 +58,32 @@ public:
 	}
 };
 
-// Ensure that all entities obtain different IDs.
+// Ensure that all entities in an engine obtain different IDs, even when handle slots are recycled.
 TEST_F(EntityTest, UniqueIndex) {
 	const int numEntities = 1000;
-	std::bitset<numEntities * 4> ids;
+	ashley::Engine engine;
+	std::unordered_set<uint64_t> ids;
+
+	ASSERT_EQ(0u, emptyEntity.getIndex());
+	ASSERT_TRUE(emptyEntity.getHandle().isNull());
 
 	for (int i = 0; i < numEntities; i++) {
-		ashley::Entity e;
-		ASSERT_FALSE(ids[(e.getIndex())] == 1) << "Non-unique entity ID generated: " << e.getIndex() << ".";
+		auto e = engine.addEntity();
+		ASSERT_TRUE(ids.insert(e->getIndex()).second) << "Non-unique entity ID generated: " << e->getIndex() << ".";
+
+		if (i % 2 == 0) {
+			engine.removeEntity(e);
+		}
 	}
 }
 
+// Ensure that entities outside an engine are only equal to themselves.
+TEST_F(EntityTest, DetachedEquality) {
+	ASSERT_TRUE(emptyEntity == emptyEntity);
+	ASSERT_FALSE(emptyEntity == onlyPosition);
+	ASSERT_TRUE(emptyEntity != onlyPosition);
+}
+
 // Ensure that an empty entity is treated correctly by various functions.
 TEST_F(EntityTest, NoComponents) {
 	ashley::test::assertValidComponentAndBitSize(emptyEntity, 0);
@@ -248,3 +265,107 @@ TEST_F(EntityTest, ComponentListener) {
 	ASSERT_EQ(2u, dynAdd->counter);
 	ASSERT_EQ(2u, dynRem->counter);
 }
+
+// Ensure that components added and removed out of index order are still found correctly.
+TEST_F(EntityTest, ComponentsAddedOutOfOrder) {
+	onlyVelocity.add<ashley::test::PositionComponent>(initialXPos, initialYPos);
+	ashley::test::assertValidComponentAndBitSize(onlyVelocity, 2);
+
+	auto posComp = onlyVelocity.getComponent<ashley::test::PositionComponent>();
+	auto velComp = onlyVelocity.getComponent<ashley::test::VelocityComponent>();
+
+	ASSERT_FALSE(posComp == nullptr);
+	ASSERT_FALSE(velComp == nullptr);
+	EXPECT_EQ(initialXPos, posComp->x);
+	EXPECT_EQ(initialXVel, velComp->x);
+
+	auto removed = onlyVelocity.remove<ashley::test::VelocityComponent>();
+
+	ASSERT_FALSE(removed == nullptr);
+	EXPECT_EQ(initialXVel, removed->x);
+	ashley::test::assertValidComponentAndBitSize(onlyVelocity, 1);
+	EXPECT_EQ(initialXPos, onlyVelocity.getComponent<ashley::test::PositionComponent>()->x);
+}
+
+namespace {
+class TimerComponent : public ashley::Component {
+public:
+	float remaining;
+
+	explicit TimerComponent(float remaining = 0.0f) :
+			remaining(remaining) {
+	}
+};
+
+class BuffComponent : public ashley::Component, public ashley::Poolable {
+public:
+	static uint64_t resets;
+
+	int64_t strength = 0;
+
+	void reset() override {
+		strength = 0;
+		++resets;
+	}
+};
+
+uint64_t BuffComponent::resets = 0u;
+
+class UnmovableComponent : public ashley::Component {
+public:
+	int64_t value;
+
+	explicit UnmovableComponent(int64_t value) :
+			value(value) {
+	}
+
+	UnmovableComponent(const UnmovableComponent &other) = delete;
+	UnmovableComponent(UnmovableComponent &&other) = delete;
+};
+}
+
+// Ensure that the memory of removed components is reused for the next component of the same type.
+TEST_F(EntityTest, ComponentMemoryIsRecycled) {
+	emptyEntity.add<TimerComponent>(1.0f);
+	auto first = emptyEntity.getComponent<TimerComponent>();
+
+	// the component is moved out of pooled memory so it stays valid after being removed
+	auto removed = emptyEntity.remove<TimerComponent>();
+	ASSERT_FALSE(removed == nullptr);
+	ASSERT_NE(first, removed.get());
+	EXPECT_EQ(1.0f, removed->remaining);
+
+	emptyEntity.add<TimerComponent>(2.0f);
+	ASSERT_EQ(first, emptyEntity.getComponent<TimerComponent>());
+	EXPECT_EQ(2.0f, emptyEntity.getComponent<TimerComponent>()->remaining);
+
+	onlyPosition.add<TimerComponent>(3.0f);
+	ASSERT_NE(first, onlyPosition.getComponent<TimerComponent>());
+}
+
+// Ensure that poolable components are reset on removal and reused when added without arguments.
+TEST_F(EntityTest, PoolableComponentsAreReset) {
+	const auto resetsBefore = BuffComponent::resets;
+
+	emptyEntity.add<BuffComponent>();
+	auto buff = emptyEntity.getComponent<BuffComponent>();
+	buff->strength = 10;
+
+	emptyEntity.removeAll();
+	ASSERT_EQ(resetsBefore + 1, BuffComponent::resets);
+
+	emptyEntity.add<BuffComponent>();
+	ASSERT_EQ(buff, emptyEntity.getComponent<BuffComponent>());
+	EXPECT_EQ(0, emptyEntity.getComponent<BuffComponent>()->strength);
+}
+
+// Ensure that components which can't be moved can still be added and removed.
+TEST_F(EntityTest, UnmovableComponents) {
+	emptyEntity.add<UnmovableComponent>(7);
+	EXPECT_EQ(7, emptyEntity.getComponent<UnmovableComponent>()->value);
+
+	auto removed = emptyEntity.remove<UnmovableComponent>();
+	ASSERT_FALSE(removed == nullptr);
+	EXPECT_EQ(7, removed->value);
+	ashley::test::assertValidComponentAndBitSize(emptyEntity, 0);
+}
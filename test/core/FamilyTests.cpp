@@ -102,6 +102,11 @@ TEST_F(FamilyTest, SameFamily) {
 
 	auto familyCBA = Family::getFor({typeid(ComponentC), typeid(ComponentB), typeid(ComponentA)});
 	ASSERT_TRUE(familyCBA == family7);
+
+	ASSERT_EQ(family1, Family::getFor<ComponentA>());
+	ASSERT_EQ(family4, (Family::getFor<ComponentB, ComponentA>()));
+	ASSERT_EQ(family7, (Family::getFor<ComponentA, ComponentB, ComponentC>()));
+	ASSERT_EQ(family7, (Family::getFor<ComponentA, ComponentB, ComponentC>()));
 }
 
 // Ensure that different invocations produce different families, including with different orders of components.
@@ -245,3 +250,45 @@ TEST_F(FamilyTest, FamilyFiltering) {
 	ASSERT_FALSE(family8->matches(e));
 	ASSERT_TRUE(family12->matches(e));
 }
+
+// Ensure that families described by bits beyond the inline words, or differing only in which set a bit is in, are
+// looked up correctly.
+TEST_F(FamilyTest, FamilyLookupByBits) {
+	ashley::BitsType high;
+	high.set(200);
+
+	auto family1 = Family::getFor(high, ashley::BitsType(), ashley::BitsType());
+	auto family2 = Family::getFor(high, ashley::BitsType(), ashley::BitsType());
+	auto family3 = Family::getFor(ashley::BitsType(), high, ashley::BitsType());
+	auto family4 = Family::getFor(ashley::BitsType(), ashley::BitsType(), high);
+
+	ASSERT_EQ(family1, family2);
+	ASSERT_NE(family1, family3);
+	ASSERT_NE(family1, family4);
+	ASSERT_NE(family3, family4);
+	ASSERT_EQ(high, family1->getAll());
+	ASSERT_EQ(high, family3->getOne());
+	ASSERT_EQ(high, family4->getExclude());
+}
+
+// Ensure that matching handles entity bits with more or fewer words than the family's.
+TEST_F(FamilyTest, MatchBitsOfDifferentSizes) {
+	ashley::BitsType low;
+	low.set(1);
+
+	ashley::BitsType high;
+	high.set(500);
+
+	auto requiresHigh = Family::getFor(high, ashley::BitsType(), ashley::BitsType());
+	auto excludesHigh = Family::getFor(low, ashley::BitsType(), high);
+	auto oneOfBoth = Family::getFor(ashley::BitsType(), low | high, ashley::BitsType());
+
+	ASSERT_FALSE(requiresHigh->matches(low));
+	ASSERT_TRUE(requiresHigh->matches(low | high));
+	ASSERT_TRUE(excludesHigh->matches(low));
+	ASSERT_FALSE(excludesHigh->matches(low | high));
+	ASSERT_FALSE(excludesHigh->matches(high));
+	ASSERT_TRUE(oneOfBoth->matches(high));
+	ASSERT_FALSE(oneOfBoth->matches(ashley::BitsType().set(2)));
+	ASSERT_FALSE(oneOfBoth->matches(ashley::BitsType()));
+}
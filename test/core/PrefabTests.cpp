@@ -0,0 +1,162 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/Family.hpp"
+#include "Ashley/core/Prefab.hpp"
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::ComponentType;
+using ashley::Engine;
+using ashley::Entity;
+using ashley::EntitySystem;
+using ashley::Family;
+using ashley::Prefab;
+using ashley::test::PositionComponent;
+using ashley::test::VelocityComponent;
+
+namespace {
+class NameComponent : public ashley::Component {
+public:
+	explicit NameComponent(std::string name = "") :
+			name(std::move(name)) {
+	}
+
+	std::string name;
+};
+
+class SpawnerSystem final : public EntitySystem {
+public:
+	explicit SpawnerSystem(const Prefab &prefab) :
+			EntitySystem(0),
+			prefab(prefab) {
+	}
+
+	Entity *spawned = nullptr;
+
+	void update(float deltaTime) override {
+		spawned = getEngine()->instantiate(prefab);
+	}
+
+private:
+	const Prefab &prefab;
+};
+
+class PrefabTest : public ::testing::Test {
+protected:
+	Prefab prefab;
+
+	PrefabTest() {
+		prefab.add<PositionComponent>(3, 4).add<NameComponent>("enemy");
+	}
+
+	void checkInstances(Engine &engine) {
+		auto positioned = engine.getEntitiesFor(Family::getFor<PositionComponent>());
+		auto moving = engine.getEntitiesFor(Family::getFor<PositionComponent, VelocityComponent>());
+
+		std::vector<Entity *> instances;
+
+		engine.instantiate(prefab, 100, [&](Entity &entity, std::size_t i) {
+			entity.getComponent<PositionComponent>()->x = static_cast<int64_t>(i);
+
+			if (i % 2 == 0) {
+				entity.add<VelocityComponent>(1, 1);
+			}
+
+			instances.push_back(&entity);
+		});
+
+		ASSERT_EQ(100u, positioned->size());
+		ASSERT_EQ(50u, moving->size());
+
+		for (std::size_t i = 0u; i < instances.size(); ++i) {
+			auto instance = instances[i];
+
+			ASSERT_TRUE(engine.isValid(instance->getHandle()));
+			ASSERT_EQ(static_cast<int64_t>(i), instance->getComponent<PositionComponent>()->x);
+			ASSERT_EQ(4, instance->getComponent<PositionComponent>()->y);
+			ASSERT_EQ("enemy", instance->getComponent<NameComponent>()->name);
+			ASSERT_EQ(i % 2 == 0, instance->hasComponent<VelocityComponent>());
+		}
+
+		// changing an instance leaves the prototype alone, and changing the prototype only affects later instances
+		ASSERT_EQ(3, prefab.getComponent<PositionComponent>()->x);
+
+		prefab.getComponent<NameComponent>()->name = "boss";
+		auto boss = engine.instantiate(prefab);
+
+		ASSERT_EQ("boss", boss->getComponent<NameComponent>()->name);
+		ASSERT_EQ("enemy", instances[0]->getComponent<NameComponent>()->name);
+		ASSERT_EQ(101u, positioned->size());
+
+		prefab.getComponent<NameComponent>()->name = "enemy";
+	}
+};
+}
+
+// Ensure that a prefab keeps one component of each type, in any order they were added.
+TEST_F(PrefabTest, CapturesComponents) {
+	prefab.add<VelocityComponent>(5, 6).add<PositionComponent>(7, 8);
+
+	ASSERT_EQ(3u, prefab.countComponents());
+	ASSERT_TRUE(prefab.hasComponent<VelocityComponent>());
+	ASSERT_EQ(7, prefab.getComponent<PositionComponent>()->x);
+	ASSERT_EQ(6, prefab.getComponent<VelocityComponent>()->y);
+	ASSERT_EQ((ComponentType::getBitsFor<PositionComponent, VelocityComponent, NameComponent>()),
+	        prefab.getComponentBits());
+
+	Prefab empty;
+	ASSERT_EQ(nullptr, empty.getComponent<PositionComponent>());
+}
+
+// Ensure that instances with individually stored components are independent copies of the prefab.
+TEST_F(PrefabTest, InstantiateIndividualStorage) {
+	Engine engine;
+	checkInstances(engine);
+}
+
+// Ensure that instances copied straight into archetype storage are independent copies of the prefab.
+TEST_F(PrefabTest, InstantiateArchetypeStorage) {
+	Engine engine(Engine::StorageMode::ARCHETYPE);
+	checkInstances(engine);
+
+	ASSERT_NE(nullptr, ComponentType::getFor<PositionComponent>().getOperations().copyConstruct);
+	ASSERT_NE(nullptr, ComponentType::getFor<NameComponent>().getOperations().copyConstruct);
+}
+
+// Ensure that prefabs instantiated during an update are added once the systems have finished.
+TEST_F(PrefabTest, InstantiateDuringUpdate) {
+	Engine engine(Engine::StorageMode::ARCHETYPE);
+	auto named = engine.getEntitiesFor(Family::getFor<NameComponent>());
+	auto spawner = engine.addSystem<SpawnerSystem>(prefab);
+
+	engine.update(0.1f);
+	engine.update(0.1f);
+
+	ASSERT_EQ(2u, named->size());
+	ASSERT_TRUE(engine.isValid(spawner->spawned->getHandle()));
+	ASSERT_EQ("enemy", spawner->spawned->getComponent<NameComponent>()->name);
+	ASSERT_EQ(3, spawner->spawned->getComponent<PositionComponent>()->x);
+}
@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/EntitySystem.hpp"
+#include "Ashley/util/ThreadPool.hpp"
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::Engine;
+using ashley::Entity;
+using ashley::EntitySystem;
+using ashley::test::PositionComponent;
+using ashley::test::VelocityComponent;
+
+namespace {
+struct UpdateLog {
+	std::mutex mutex;
+	std::vector<int64_t> priorities;
+
+	void record(int64_t priority) {
+		std::lock_guard<std::mutex> lock(mutex);
+		priorities.push_back(priority);
+	}
+};
+
+// distinct types so that several can be added to one engine
+template<int N> class LoggingSystem : public EntitySystem {
+public:
+	explicit LoggingSystem(int64_t priority, UpdateLog *log) :
+			        EntitySystem(priority),
+			        log(log) {
+	}
+
+	void update(float deltaTime) override {
+		log->record(priority);
+	}
+
+private:
+	UpdateLog *log;
+};
+
+template<int N> class TagComponent : public ashley::Component {
+};
+
+template<int N> class TaggingSystem : public EntitySystem {
+public:
+	explicit TaggingSystem(std::vector<Entity *> *entities) :
+			        EntitySystem(0),
+			        entities(entities) {
+		declareWrites<TagComponent<N>>();
+	}
+
+	void update(float deltaTime) override {
+		for (auto entity : *entities) {
+			entity->add<TagComponent<N>>();
+		}
+	}
+
+private:
+	std::vector<Entity *> *entities;
+};
+
+class RendezvousSystem : public EntitySystem {
+public:
+	explicit RendezvousSystem(std::atomic<int> *arrived) :
+			        EntitySystem(0),
+			        arrived(arrived) {
+	}
+
+	bool met = false;
+
+	void update(float deltaTime) override {
+		++(*arrived);
+
+		const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+		while (arrived->load() < 2 && std::chrono::steady_clock::now() < giveUp) {
+			std::this_thread::yield();
+		}
+
+		met = arrived->load() >= 2;
+	}
+
+private:
+	std::atomic<int> *arrived;
+};
+
+class RendezvousSystemA final : public RendezvousSystem {
+public:
+	explicit RendezvousSystemA(std::atomic<int> *arrived) :
+			        RendezvousSystem(arrived) {
+		declareWrites<PositionComponent>();
+	}
+};
+
+class RendezvousSystemB final : public RendezvousSystem {
+public:
+	explicit RendezvousSystemB(std::atomic<int> *arrived) :
+			        RendezvousSystem(arrived) {
+		declareWrites<VelocityComponent>();
+	}
+};
+
+// meets another ViewingSystem so that both request the same new families at the same time
+template<int N> class ViewingSystem : public RendezvousSystem {
+public:
+	explicit ViewingSystem(std::atomic<int> *arrived) :
+			        RendezvousSystem(arrived) {
+		declareReads<PositionComponent, VelocityComponent>();
+	}
+
+	std::size_t positions = 0u;
+	std::size_t moving = 0u;
+	ashley::Family *tagged = nullptr;
+
+	void update(float deltaTime) override {
+		RendezvousSystem::update(deltaTime);
+
+		positions = getEngine()->view<const PositionComponent>().size();
+		moving = getEngine()->view<const PositionComponent, const VelocityComponent>().size();
+
+		tagged = ashley::Family::getFor<PositionComponent, TagComponent<N>>();
+		getEngine()->getEntitiesFor(tagged);
+	}
+};
+}
+
+// Ensure that declared access is used to decide which systems conflict.
+TEST(SystemSchedulerTest, Conflicts) {
+	UpdateLog log;
+	LoggingSystem<0> undeclared(0, &log);
+	LoggingSystem<1> readsPosition(0, &log);
+	LoggingSystem<2> readsPositionAgain(0, &log);
+	LoggingSystem<3> writesPosition(0, &log);
+	LoggingSystem<4> writesVelocity(0, &log);
+
+	readsPosition.declareReads<PositionComponent>();
+	readsPositionAgain.declareReads<PositionComponent>();
+	writesPosition.declareWrites<PositionComponent>();
+	writesVelocity.declareReads<PositionComponent>();
+	writesVelocity.declareWrites<VelocityComponent>();
+
+	ASSERT_FALSE(undeclared.hasDeclaredAccess());
+	ASSERT_TRUE(undeclared.conflictsWith(readsPosition));
+	ASSERT_FALSE(readsPosition.conflictsWith(readsPositionAgain));
+	ASSERT_TRUE(readsPosition.conflictsWith(writesPosition));
+	ASSERT_TRUE(writesPosition.conflictsWith(readsPosition));
+	ASSERT_FALSE(readsPosition.conflictsWith(writesVelocity));
+	ASSERT_TRUE(writesPosition.conflictsWith(writesVelocity));
+}
+
+// Ensure that conflicting systems always run in priority order when updated in parallel.
+TEST(SystemSchedulerTest, ConflictingSystemsKeepPriorityOrder) {
+	Engine engine;
+	UpdateLog log;
+
+	engine.setThreadCount(3);
+	ASSERT_EQ(3u, engine.getThreadCount());
+
+	engine.addSystem<LoggingSystem<0>>(3, &log)->declareWrites<PositionComponent>();
+	engine.addSystem<LoggingSystem<1>>(1, &log)->declareWrites<PositionComponent>();
+	engine.addSystem<LoggingSystem<2>>(2, &log);
+	engine.addSystem<LoggingSystem<3>>(0, &log)->declareReads<PositionComponent>();
+
+	const std::vector<int64_t> expected { 0, 1, 2, 3 };
+
+	for (int i = 0; i < 50; ++i) {
+		log.priorities.clear();
+		engine.update(0.16f);
+
+		ASSERT_EQ(expected, log.priorities);
+	}
+
+	engine.setThreadCount(0);
+	ASSERT_EQ(0u, engine.getThreadCount());
+	ASSERT_TRUE(engine.getThreadPool() == nullptr);
+
+	log.priorities.clear();
+	engine.update(0.16f);
+
+	ASSERT_EQ(expected, log.priorities);
+}
+
+// Ensure that systems which don't conflict are updated at the same time.
+TEST(SystemSchedulerTest, NonConflictingSystemsOverlap) {
+	Engine engine;
+	std::atomic<int> arrived(0);
+
+	engine.setThreadCount(2);
+
+	auto a = engine.addSystem<RendezvousSystemA>(&arrived);
+	auto b = engine.addSystem<RendezvousSystemB>(&arrived);
+
+	engine.update(0.16f);
+
+	ASSERT_TRUE(a->met);
+	ASSERT_TRUE(b->met);
+}
+
+// Ensure that component operations deferred by systems running in parallel are all applied.
+TEST(SystemSchedulerTest, ParallelDeferredOperations) {
+	Engine engine;
+	std::vector<Entity *> entities;
+
+	for (int i = 0; i < 200; ++i) {
+		entities.push_back(engine.addEntity());
+	}
+
+	engine.setThreadCount(3);
+
+	engine.addSystem<TaggingSystem<0>>(&entities);
+	engine.addSystem<TaggingSystem<1>>(&entities);
+	engine.addSystem<TaggingSystem<2>>(&entities);
+	engine.addSystem<TaggingSystem<3>>(&entities);
+
+	engine.update(0.16f);
+
+	for (auto entity : entities) {
+		ASSERT_TRUE(entity->hasComponent<TagComponent<0>>());
+		ASSERT_TRUE(entity->hasComponent<TagComponent<1>>());
+		ASSERT_TRUE(entity->hasComponent<TagComponent<2>>());
+		ASSERT_TRUE(entity->hasComponent<TagComponent<3>>());
+		ashley::test::assertValidComponentAndBitSize(*entity, 4);
+	}
+}
+
+// Ensure that families first requested by systems running in parallel are registered once, and kept up to date.
+TEST(SystemSchedulerTest, ParallelFamilyRegistration) {
+	Engine engine;
+	std::atomic<int> arrived(0);
+
+	for (int i = 0; i < 200; ++i) {
+		auto entity = engine.addEntity();
+		entity->add<PositionComponent>(i, 0);
+
+		if (i % 2 == 0) {
+			entity->add<VelocityComponent>(0, i);
+		}
+	}
+
+	engine.setThreadCount(2);
+
+	auto a = engine.addSystem<ViewingSystem<0>>(&arrived);
+	auto b = engine.addSystem<ViewingSystem<1>>(&arrived);
+
+	engine.update(0.16f);
+
+	ASSERT_TRUE(a->met);
+	ASSERT_TRUE(b->met);
+	ASSERT_EQ(200u, a->positions);
+	ASSERT_EQ(200u, b->positions);
+	ASSERT_EQ(100u, a->moving);
+	ASSERT_EQ(100u, b->moving);
+
+	// each family is registered once, and sees entities added after the update
+	const auto positions = engine.getEntitiesFor(ashley::Family::getFor<PositionComponent>());
+	ASSERT_EQ(positions, engine.getEntitiesFor(ashley::Family::getFor<PositionComponent>()));
+
+	auto added = engine.addEntity();
+	added->add<PositionComponent>(0, 0).add<TagComponent<0>>();
+
+	ASSERT_EQ(201u, positions->size());
+	ASSERT_EQ(1u, engine.getEntitiesFor(a->tagged)->size());
+	ASSERT_EQ(0u, engine.getEntitiesFor(b->tagged)->size());
+}
+
+// Ensure that a thread waiting for work running on another thread sleeps rather than spinning.
+TEST(SystemSchedulerTest, WaitingThreadSleeps) {
+	ashley::ThreadPool pool(1u);
+	std::atomic<std::size_t> remaining(1u);
+	std::atomic<bool> started(false);
+
+	pool.submit([&]() {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		--remaining;
+	});
+
+	while (!started.load()) {
+		std::this_thread::yield();
+	}
+
+	const auto cpuStart = std::clock();
+	pool.waitFor(remaining);
+	const auto cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+	ASSERT_EQ(0u, remaining.load());
+	ASSERT_LT(cpuSeconds, 0.1);
+}
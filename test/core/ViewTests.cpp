@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/View.hpp"
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::Engine;
+using ashley::Entity;
+using ashley::test::PositionComponent;
+using ashley::test::VelocityComponent;
+
+namespace {
+class TagComponent : public ashley::Component {
+};
+
+class ViewTest : public ::testing::Test {
+protected:
+	static const int64_t entityCount = 1000;
+
+	std::vector<Entity *> moving;
+
+	// every entity has a position, every other one a velocity and every third one a tag, so the view's entities are
+	// spread over two archetypes and several chunks in archetype storage
+	void populate(Engine &engine) {
+		for (int64_t i = 0; i < entityCount; i++) {
+			auto e = engine.addEntity();
+			e->add<PositionComponent>(i, 0);
+
+			if (i % 2 == 0) {
+				e->add<VelocityComponent>(1, i);
+				moving.push_back(e);
+			}
+
+			if (i % 3 == 0) {
+				e->add<TagComponent>();
+			}
+		}
+	}
+
+	void checkView(Engine &engine) {
+		populate(engine);
+
+		auto view = engine.view<PositionComponent, VelocityComponent>();
+		ASSERT_EQ(moving.size(), view.size());
+
+		std::size_t visited = 0u;
+
+		view.each([&](PositionComponent &position, VelocityComponent &velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+			visited++;
+		});
+
+		ASSERT_EQ(moving.size(), visited);
+
+		for (auto e : moving) {
+			const auto position = e->getComponent<PositionComponent>();
+			ASSERT_EQ(position->x - 1, position->y);
+		}
+
+		visited = 0u;
+
+		view.eachWithEntity([&](Entity &entity, PositionComponent &position, VelocityComponent &) {
+			ASSERT_EQ(entity.getComponent<PositionComponent>(), &position);
+			visited++;
+		});
+
+		ASSERT_EQ(moving.size(), visited);
+
+		// views over a single component see every entity
+		visited = 0u;
+		engine.view<PositionComponent>().each([&](PositionComponent &) {visited++;});
+		ASSERT_EQ(static_cast<std::size_t>(entityCount), visited);
+	}
+
+	std::size_t countChanged(Engine &engine, uint64_t tick) {
+		std::size_t visited = 0u;
+
+		auto view = engine.view<const PositionComponent, const VelocityComponent>();
+		view.changedSince<const VelocityComponent>(tick).each(
+		        [&](const PositionComponent &, const VelocityComponent &) {visited++;});
+
+		return visited;
+	}
+
+	void checkChangeTracking(Engine &engine) {
+		populate(engine);
+
+		// components which exist when tracking starts count as changed
+		engine.trackChanges<VelocityComponent>();
+		ASSERT_TRUE(engine.isTrackingChanges<VelocityComponent>());
+		ASSERT_FALSE(engine.isTrackingChanges<PositionComponent>());
+		ASSERT_EQ(moving.size(), countChanged(engine, engine.getChangeTick()));
+		ASSERT_EQ(engine.getChangeTick(), moving.front()->getChangeTick<VelocityComponent>());
+		ASSERT_EQ(0u, moving.front()->getChangeTick<PositionComponent>());
+
+		engine.update(0.0f);
+		auto tick = engine.getChangeTick();
+		ASSERT_EQ(0u, countChanged(engine, tick));
+
+		// reading through const components and changing untracked ones records nothing
+		engine.view<PositionComponent, const VelocityComponent>().each(
+		        [](PositionComponent &position, const VelocityComponent &velocity) {position.x += velocity.x;});
+		ASSERT_EQ(0u, countChanged(engine, tick));
+
+		moving[1]->markChanged<VelocityComponent>();
+		moving[3]->markChanged<VelocityComponent>();
+		ASSERT_EQ(2u, countChanged(engine, tick));
+
+		std::vector<Entity *> changed;
+		engine.view<VelocityComponent>().changedSince<VelocityComponent>(tick).eachWithEntity(
+		        [&](Entity &entity, VelocityComponent &) {changed.push_back(&entity);});
+		ASSERT_EQ(2u, changed.size());
+
+		// adding a component counts as a change, and removed components have no tick
+		auto added = engine.addEntity();
+		added->add<PositionComponent>(0, 0).add<VelocityComponent>(0, 0);
+		ASSERT_EQ(3u, countChanged(engine, tick));
+		added->remove<VelocityComponent>();
+		ASSERT_EQ(0u, added->getChangeTick<VelocityComponent>());
+
+		// iterating non-const components of a tracked type records every one as changed
+		engine.update(0.0f);
+		tick = engine.getChangeTick();
+		engine.view<VelocityComponent>().each([](VelocityComponent &) {});
+		ASSERT_EQ(moving.size(), countChanged(engine, tick));
+	}
+};
+}
+
+// Ensure that views visit the components of every matching entity in heap storage mode.
+TEST_F(ViewTest, HeapStorage) {
+	Engine engine;
+	checkView(engine);
+}
+
+// Ensure that views visit the components of every matching entity in archetype storage mode.
+TEST_F(ViewTest, ArchetypeStorage) {
+	Engine engine { Engine::StorageMode::ARCHETYPE };
+	checkView(engine);
+}
+
+// Ensure that a view sees entities added after it was created.
+TEST_F(ViewTest, ViewSeesNewEntities) {
+	Engine engine;
+	auto view = engine.view<PositionComponent, VelocityComponent>();
+
+	ASSERT_EQ(0u, view.size());
+
+	populate(engine);
+
+	ASSERT_EQ(moving.size(), view.size());
+}
+
+// Ensure that views only visit entities whose tracked component changed since a tick, in heap storage mode.
+TEST_F(ViewTest, HeapChangeTracking) {
+	Engine engine;
+	checkChangeTracking(engine);
+}
+
+// Ensure that views only visit entities whose tracked component changed since a tick, in archetype storage mode.
+TEST_F(ViewTest, ArchetypeChangeTracking) {
+	Engine engine { Engine::StorageMode::ARCHETYPE };
+	checkChangeTracking(engine);
+}
+
+// Ensure that changes are found in a family which is a small part of the engine, where members are checked one by one.
+TEST_F(ViewTest, ChangeTrackingInSmallFamily) {
+	Engine engine;
+	engine.trackChanges<VelocityComponent>();
+
+	for (int64_t i = 0; i < entityCount; i++) {
+		engine.addEntity()->add<PositionComponent>(i, 0);
+	}
+
+	auto first = engine.addEntity();
+	first->add<PositionComponent>(0, 0).add<VelocityComponent>(0, 0);
+	engine.addEntity()->add<PositionComponent>(0, 0).add<VelocityComponent>(0, 0);
+
+	engine.update(0.0f);
+	const auto tick = engine.getChangeTick();
+	first->markChanged<VelocityComponent>();
+
+	std::vector<Entity *> changed;
+	engine.view<const PositionComponent, VelocityComponent>().changedSince<VelocityComponent>(tick).eachWithEntity(
+	        [&](Entity &entity, const PositionComponent &, VelocityComponent &) {changed.push_back(&entity);});
+
+	ASSERT_EQ(1u, changed.size());
+	ASSERT_EQ(first, changed.front());
+}
@@ -1,6 +1,7 @@
 #include <cstdint>
 
 #include <memory>
+#include <vector>
 
 #include "Ashley/core/Component.hpp"
 #include "Ashley/core/Engine.hpp"
@@ -103,6 +104,60 @@ public:
 	}
 };
 
+class IteratingRemoveAllMock : public IteratingSystem {
+private:
+	ComponentMapper<SpyComponent> sm;
+	ComponentMapper<IndexComponent> im;
+
+public:
+	explicit IteratingRemoveAllMock(int64_t priority = 0) :
+			IteratingSystem(ashley::Family::getFor({typeid(SpyComponent), typeid(IndexComponent)}),
+							priority),
+			sm(ComponentMapper<SpyComponent>::getMapper()),
+			im(ComponentMapper<IndexComponent>::getMapper()) {
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		auto index = im.get(entity)->index;
+
+		if (index % 2 == 0) {
+			entity->removeAll();
+		} else {
+			sm.get(entity)->updates++;
+		}
+	}
+};
+
+void checkRemoveAllWhileIterating(Engine &engine) {
+	auto entities = engine.getEntitiesFor(Family::getFor({typeid(SpyComponent), typeid(IndexComponent)}));
+	auto sm = ComponentMapper<SpyComponent>::getMapper();
+
+	engine.addSystem<IteratingRemoveAllMock>(10);
+
+	constexpr uint64_t numEntities = 10u;
+	std::vector<Entity *> added;
+
+	for (uint64_t i = 0u; i < numEntities; i++) {
+		auto e = engine.addEntity();
+
+		e->add<SpyComponent>();
+		e->add<IndexComponent>(i + 1);
+		added.push_back(e);
+	}
+
+	engine.update(0.16f);
+
+	ASSERT_EQ(numEntities / 2, entities->size());
+
+	for (auto e : added) {
+		if (e->hasComponent<SpyComponent>()) {
+			ASSERT_EQ(1, sm.get(e)->updates);
+		} else {
+			ASSERT_EQ(0u, e->countComponents());
+		}
+	}
+}
+
 class IteratingRemovalMock : public IteratingSystem {
 private:
 	ComponentMapper<SpyComponent> sm;
@@ -222,3 +277,14 @@ TEST_F(IteratingSystemTest, ComponentRemovalWhileIterating) {
 		ASSERT_EQ(1, sm.get(e)->updates);
 	}
 }
+
+// Ensure that removing every component of an entity while iterating is deferred until the update finishes.
+TEST_F(IteratingSystemTest, RemoveAllWhileIterating) {
+	checkRemoveAllWhileIterating(engine);
+}
+
+// As above, with the components stored in archetypes.
+TEST_F(IteratingSystemTest, RemoveAllWhileIteratingArchetypes) {
+	Engine archetypeEngine { Engine::StorageMode::ARCHETYPE };
+	checkRemoveAllWhileIterating(archetypeEngine);
+}
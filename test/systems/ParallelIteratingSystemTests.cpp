@@ -0,0 +1,155 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/core/Component.hpp"
+#include "Ashley/core/ComponentType.hpp"
+#include "Ashley/core/Engine.hpp"
+
+#include "Ashley/systems/ParallelIteratingSystem.hpp"
+
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::Entity;
+using ashley::Engine;
+using ashley::Family;
+using ashley::ParallelIteratingSystem;
+
+namespace {
+class CounterComponent : public ashley::Component {
+public:
+	explicit CounterComponent(int64_t index = 0) :
+			index(index) {
+	}
+
+	int64_t index;
+	int64_t updates = 0;
+};
+
+class MarkerComponent : public ashley::Component {
+};
+
+class CountingSystem final : public ParallelIteratingSystem {
+public:
+	explicit CountingSystem(std::size_t chunkSize) :
+			ParallelIteratingSystem(Family::getFor({typeid(CounterComponent)}), 0, chunkSize) {
+		declareWrites<CounterComponent>();
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		++entity->getComponent<CounterComponent>()->updates;
+	}
+};
+
+class StructuralSystem final : public ParallelIteratingSystem {
+public:
+	StructuralSystem() :
+			ParallelIteratingSystem(Family::getFor({typeid(CounterComponent)}), 0, 8) {
+		ashley::ComponentType::getFor<MarkerComponent>();
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		const auto index = entity->getComponent<CounterComponent>()->index;
+
+		if (index % 3 == 0) {
+			getEngine()->removeEntity(entity);
+		} else if (index % 3 == 1) {
+			entity->add<MarkerComponent>();
+		}
+	}
+};
+
+class SpawnedComponent : public ashley::Component {
+public:
+	explicit SpawnedComponent(int64_t index = 0) :
+			index(index) {
+	}
+
+	int64_t index;
+};
+
+class SpawningSystem final : public ParallelIteratingSystem {
+public:
+	SpawningSystem() :
+			ParallelIteratingSystem(Family::getFor({typeid(CounterComponent)}), 0, 8) {
+		ashley::ComponentType::getFor<SpawnedComponent>();
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		const auto index = entity->getComponent<CounterComponent>()->index;
+
+		if (index % 2 == 0) {
+			getEngine()->addEntity()->add<SpawnedComponent>(index);
+		}
+	}
+};
+
+class ParallelIteratingSystemTest : public ::testing::Test {
+protected:
+	constexpr static float delta = 0.15f;
+	constexpr static int64_t entityCount = 1000;
+
+	Engine engine;
+
+	ParallelIteratingSystemTest() {
+		for (int64_t i = 0; i < entityCount; ++i) {
+			engine.addEntity()->add<CounterComponent>(i);
+		}
+	}
+};
+}
+
+// Ensure that every entity is processed exactly once per update, with and without worker threads.
+TEST_F(ParallelIteratingSystemTest, ProcessesEachEntityOnce) {
+	auto system = engine.addSystem<CountingSystem>(16);
+	auto entities = engine.getEntitiesFor(Family::getFor({typeid(CounterComponent)}));
+
+	engine.update(delta);
+	engine.setThreadCount(3);
+	engine.update(delta);
+	engine.update(delta);
+
+	ASSERT_EQ(16u, system->getChunkSize());
+
+	for (auto entity : *entities) {
+		ASSERT_EQ(3, entity->getComponent<CounterComponent>()->updates);
+	}
+}
+
+// Ensure that structural changes made from several threads are deferred and applied after the update.
+TEST_F(ParallelIteratingSystemTest, StructuralChangesAreDeferred) {
+	engine.setThreadCount(3);
+	engine.addSystem<StructuralSystem>();
+
+	auto counted = engine.getEntitiesFor(Family::getFor({typeid(CounterComponent)}));
+	auto marked = engine.getEntitiesFor(Family::getFor({typeid(MarkerComponent)}));
+
+	engine.update(delta);
+
+	ASSERT_EQ(static_cast<std::size_t>(entityCount - (entityCount + 2) / 3), counted->size());
+	ASSERT_EQ(static_cast<std::size_t>((entityCount + 1) / 3), marked->size());
+
+	for (auto entity : *marked) {
+		ASSERT_EQ(1, entity->getComponent<CounterComponent>()->index % 3);
+	}
+}
+
+
+// Ensure that entities added from several threads are added in the order their sources were processed.
+TEST_F(ParallelIteratingSystemTest, AddedEntitiesAreOrdered) {
+	engine.setThreadCount(3);
+	engine.addSystem<SpawningSystem>();
+
+	auto spawned = engine.getEntitiesFor(Family::getFor({typeid(SpawnedComponent)}));
+
+	engine.update(delta);
+
+	ASSERT_EQ(static_cast<std::size_t>((entityCount + 1) / 2), spawned->size());
+
+	for (std::size_t i = 0u; i < spawned->size(); ++i) {
+		ASSERT_EQ(static_cast<int64_t>(i * 2), spawned->at(i)->getComponent<SpawnedComponent>()->index);
+	}
+}
\ No newline at end of file
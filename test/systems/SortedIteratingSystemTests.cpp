@@ -1,5 +1,6 @@
 #include <string>
 #include <list>
+#include <vector>
 #include <utility>
 
 #include "Ashley/core/Engine.hpp"
@@ -166,4 +167,42 @@ TEST_F(SortedIteratingSystemTest, EntityOrdering) {
 
 }
 
+TEST_F(SortedIteratingSystemTest, BatchAddAndRemove) {
+	auto mockSystem = engine.addSystem<SortedIteratingSystemMock>(sortFamily);
+
+	const std::vector<std::string> names {"A", "B", "C", "D", "E", "F"};
+	std::vector<Entity *> added;
+
+	// added in reverse order, so that they're only iterated in order once sorted
+	engine.addEntities<OrderedComponent>(names.size(), [&](Entity &entity, std::size_t i) {
+		auto ordered = zMapper.get(&entity);
+		ordered->name = names[i];
+		ordered->zLayer = static_cast<int>(names.size() - i);
+		added.push_back(&entity);
+	});
+
+	{
+		SCOPED_TRACE("F, E, D, C, B & A");
+		mockSystem->expectedNames.insert(mockSystem->expectedNames.end(), names.rbegin(), names.rend());
+		engine.update(delta);
+	}
+
+	engine.removeEntities({added[0], added[2], added[5]});
+
+	{
+		SCOPED_TRACE("E, D & B");
+		mockSystem->expectedNames.emplace_back("E");
+		mockSystem->expectedNames.emplace_back("D");
+		mockSystem->expectedNames.emplace_back("B");
+		engine.update(delta);
+	}
+
+	ASSERT_EQ(9u, mockSystem->numUpdates);
+
+	engine.removeAllEntities();
+	engine.update(delta);
+
+	ASSERT_EQ(9u, mockSystem->numUpdates);
+}
+
 }
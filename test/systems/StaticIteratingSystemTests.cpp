@@ -0,0 +1,135 @@
+#include <cstdint>
+
+#include <vector>
+
+#include "Ashley/core/Engine.hpp"
+#include "Ashley/core/ComponentMapper.hpp"
+#include "Ashley/systems/StaticIteratingSystem.hpp"
+#include "Ashley/systems/StaticIntervalIteratingSystem.hpp"
+#include "Ashley/systems/StaticSortedIteratingSystem.hpp"
+
+#include "AshleyTestCommon.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::test::PositionComponent;
+using ashley::test::VelocityComponent;
+
+using ashley::ComponentMapper;
+using ashley::Engine;
+using ashley::Entity;
+using ashley::Family;
+
+namespace {
+class MovementSystem final : public ashley::StaticIteratingSystem<MovementSystem> {
+public:
+	explicit MovementSystem(int64_t priority = 0) :
+			StaticIteratingSystem(Family::getFor<PositionComponent, VelocityComponent>(), priority),
+			pm(ComponentMapper<PositionComponent>::getMapper()),
+			vm(ComponentMapper<VelocityComponent>::getMapper()) {
+	}
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		auto position = pm.get(entity);
+		auto velocity = vm.get(entity);
+
+		position->x += velocity->x;
+		position->y += velocity->y;
+	}
+
+private:
+	ComponentMapper<PositionComponent> pm;
+	ComponentMapper<VelocityComponent> vm;
+};
+
+class IntervalCounterSystem final : public ashley::StaticIntervalIteratingSystem<IntervalCounterSystem> {
+public:
+	explicit IntervalCounterSystem(float interval) :
+			StaticIntervalIteratingSystem(Family::getFor<PositionComponent>(), interval, 0) {
+	}
+
+	int64_t processed = 0;
+
+	void processEntity(Entity * const entity) override {
+		++processed;
+	}
+};
+
+class SortedRecordingSystem final : public ashley::StaticSortedIteratingSystem<SortedRecordingSystem> {
+public:
+	SortedRecordingSystem() :
+			StaticSortedIteratingSystem(Family::getFor<PositionComponent>(), [](Entity *a, Entity *b) {
+				return a->getComponent<PositionComponent>()->x < b->getComponent<PositionComponent>()->x;
+			}, 0) {
+	}
+
+	std::vector<int64_t> order;
+
+	void processEntity(Entity *entity, float deltaTime) override {
+		order.push_back(entity->getComponent<PositionComponent>()->x);
+	}
+};
+
+class StaticIteratingSystemTest : public ::testing::Test {
+protected:
+	constexpr static float delta = 0.15f;
+
+	Engine engine;
+};
+}
+
+// Ensure that a static iterating system processes every entity in its family.
+TEST_F(StaticIteratingSystemTest, ProcessesFamily) {
+	engine.addSystem<MovementSystem>();
+
+	std::vector<Entity *> moving;
+
+	for (int64_t i = 0; i < 10; i++) {
+		auto e = engine.addEntity();
+		e->add<PositionComponent>(0, 0);
+
+		if (i % 2 == 0) {
+			e->add<VelocityComponent>(i, 1);
+			moving.push_back(e);
+		}
+	}
+
+	engine.update(delta);
+	engine.update(delta);
+
+	for (auto e : moving) {
+		const auto position = e->getComponent<PositionComponent>();
+		const auto velocity = e->getComponent<VelocityComponent>();
+
+		ASSERT_EQ(velocity->x * 2, position->x);
+		ASSERT_EQ(2, position->y);
+	}
+}
+
+// Ensure that a static interval iterating system only processes its entities once per interval.
+TEST_F(StaticIteratingSystemTest, ProcessesOncePerInterval) {
+	auto system = engine.addSystem<IntervalCounterSystem>(delta * 2.0f);
+
+	for (int i = 0; i < 5; i++) {
+		engine.addEntity()->add<PositionComponent>();
+	}
+
+	for (int i = 0; i < 4; i++) {
+		engine.update(delta);
+	}
+
+	ASSERT_EQ(10, system->processed);
+}
+
+// Ensure that a static sorted iterating system processes its entities in order.
+TEST_F(StaticIteratingSystemTest, ProcessesInOrder) {
+	auto system = engine.addSystem<SortedRecordingSystem>();
+
+	for (int64_t x : {5, 1, 4, 2, 3}) {
+		engine.addEntity()->add<PositionComponent>(x, 0);
+	}
+
+	engine.update(delta);
+
+	ASSERT_EQ((std::vector<int64_t> {1, 2, 3, 4, 5}), system->order);
+}
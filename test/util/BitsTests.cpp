@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * Copyright 2014, 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstddef>
+
+#include <unordered_set>
+#include <utility>
+
+#include "Ashley/util/Bits.hpp"
+
+#include "gtest/gtest.h"
+
+using ashley::Bits;
+
+// Ensure that bits beyond the inline storage can be set and cleared.
+TEST(BitsTest, SetAndGrow) {
+	Bits bits;
+
+	ASSERT_TRUE(bits.none());
+	ASSERT_FALSE(bits[1000]);
+
+	bits.set(3).set(700);
+
+	ASSERT_TRUE(bits[3]);
+	ASSERT_TRUE(bits[700]);
+	ASSERT_FALSE(bits[699]);
+	ASSERT_GE(bits.size(), 701u);
+	ASSERT_EQ(2u, bits.count());
+
+	bits.reset(700);
+
+	ASSERT_FALSE(bits[700]);
+	ASSERT_EQ(1u, bits.count());
+
+	bits.reset();
+	ASSERT_TRUE(bits.none());
+}
+
+// Ensure that equality and hashing ignore how much storage each set of bits has.
+TEST(BitsTest, EqualityIgnoresSize) {
+	Bits small;
+	Bits large;
+
+	small.set(5);
+	large.set(5).set(900).reset(900);
+
+	ASSERT_EQ(small, large);
+	ASSERT_EQ(std::hash<Bits>()(small), std::hash<Bits>()(large));
+
+	large.set(900);
+
+	ASSERT_NE(small, large);
+	ASSERT_NE(large, small);
+}
+
+TEST(BitsTest, CopyAndMove) {
+	Bits bits;
+	bits.set(1).set(600);
+
+	Bits copy(bits);
+	ASSERT_EQ(bits, copy);
+
+	Bits moved(std::move(copy));
+	ASSERT_EQ(bits, moved);
+	ASSERT_TRUE(copy.none());
+
+	Bits assigned;
+	assigned.set(2);
+	assigned = moved;
+	ASSERT_EQ(bits, assigned);
+
+	assigned = Bits();
+	ASSERT_TRUE(assigned.none());
+}
+
+TEST(BitsTest, SetOperations) {
+	Bits a;
+	Bits b;
+
+	a.set(1).set(64).set(300);
+	b.set(64).set(300);
+
+	ASSERT_TRUE(a.containsAll(b));
+	ASSERT_FALSE(b.containsAll(a));
+	ASSERT_TRUE(a.intersects(b));
+
+	b.set(800);
+
+	ASSERT_FALSE(a.containsAll(b));
+	ASSERT_EQ(4u, (a | b).count());
+	ASSERT_EQ(2u, (a & b).count());
+
+	Bits c;
+	c.set(2);
+
+	ASSERT_FALSE(a.intersects(c));
+	ASSERT_TRUE(a.containsAll(Bits()));
+
+	// b has more words than a, and c fewer
+	Bits d(a);
+	d.andNot(b);
+
+	ASSERT_TRUE(d[1]);
+	ASSERT_FALSE(d[64]);
+	ASSERT_FALSE(d[300]);
+	ASSERT_EQ(1u, d.count());
+
+	d.set(700).andNot(c);
+	ASSERT_EQ(2u, d.count());
+}
+
+TEST(BitsTest, Iteration) {
+	Bits bits;
+	bits.set(0).set(63).set(64).set(513);
+
+	ASSERT_EQ(0u, bits.nextSetBit(0));
+	ASSERT_EQ(63u, bits.nextSetBit(1));
+	ASSERT_EQ(64u, bits.nextSetBit(64));
+	ASSERT_EQ(513u, bits.nextSetBit(65));
+	ASSERT_EQ(Bits::npos, bits.nextSetBit(514));
+	ASSERT_EQ(Bits::npos, bits.nextSetBit(100000));
+
+	ASSERT_EQ(0u, bits.countBelow(0));
+	ASSERT_EQ(1u, bits.countBelow(63));
+	ASSERT_EQ(3u, bits.countBelow(513));
+	ASSERT_EQ(4u, bits.countBelow(100000));
+}